@@ -0,0 +1,205 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "BatchSolver.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+bool readGeneSets(const std::string& path, const TargetMappings& mappings,
+                  std::vector<GeneSet>& sets, std::size_t& num_unknown)
+{
+	std::ifstream input(path);
+	if(!input) {
+		return false;
+	}
+
+	const NameTable& genes = mappings.geneNames();
+
+	num_unknown = 0;
+	std::string line;
+	while(std::getline(input, line)) {
+		std::istringstream fields(line);
+		GeneSet set;
+		if(!(fields >> set.name)) {
+			continue;
+		}
+
+		std::string gene;
+		while(fields >> gene) {
+			const std::size_t id = genes.find(gene);
+			if(id == NameTable::npos) {
+				++num_unknown;
+			} else {
+				set.genes.push_back(id);
+			}
+		}
+
+		std::sort(set.genes.begin(), set.genes.end());
+		set.genes.erase(std::unique(set.genes.begin(), set.genes.end()),
+		                set.genes.end());
+		sets.push_back(std::move(set));
+	}
+
+	return true;
+}
+
+BatchSolver::BatchSolver(const TargetMappings& mappings, ProblemFactory factory)
+    : mappings_(mappings),
+      factory_(std::move(factory)),
+      jobs_(1),
+      verbose_(true),
+      cache_(nullptr)
+{
+}
+
+void BatchSolver::setNumJobs(std::size_t jobs)
+{
+	jobs_ = std::max<std::size_t>(jobs, 1);
+}
+
+void BatchSolver::setVerbose(bool verbose) { verbose_ = verbose; }
+
+void BatchSolver::setCache(const ResultCache* cache, std::string problem)
+{
+	cache_ = cache;
+	problem_ = std::move(problem);
+}
+
+std::vector<BatchSolver::Result>
+BatchSolver::solve(const std::vector<GeneSet>& sets) const
+{
+	const std::size_t jobs =
+	    std::min(jobs_, std::max<std::size_t>(sets.size(), 1));
+	const int threads = ILPProblem::threadsPerJob(jobs);
+
+	std::vector<Result> results(sets.size());
+	std::atomic<std::size_t> next{0};
+	std::atomic<bool> failed{false};
+	std::mutex mutex;
+	std::size_t num_done = 0;
+	std::exception_ptr error;
+
+	auto work = [&]() {
+		for(std::size_t i = next++; i < sets.size() && !failed; i = next++) {
+			try {
+				results[i] = solve(sets[i], threads);
+			} catch(...) {
+				std::lock_guard<std::mutex> lock(mutex);
+				if(!error) {
+					error = std::current_exception();
+				}
+				failed = true;
+				return;
+			}
+
+			if(verbose_) {
+				std::lock_guard<std::mutex> lock(mutex);
+				std::cout << "\rSolved " << ++num_done << "/" << sets.size()
+				          << " gene sets";
+				std::cout.flush();
+			}
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for(size_t i = 1; i < jobs; ++i) {
+		workers.emplace_back(work);
+	}
+
+	work();
+
+	for(auto& w : workers) {
+		w.join();
+	}
+
+	if(verbose_) {
+		std::cout << '\n';
+	}
+
+	if(error) {
+		std::rethrow_exception(error);
+	}
+
+	return results;
+}
+
+BatchSolver::Result BatchSolver::solve(const GeneSet& set, int threads) const
+{
+	Result result;
+	if(set.genes.empty()) {
+		result.stats.label = set.name;
+		result.stats.status = "no genes";
+		return result;
+	}
+
+	auto restricted = mappings_.restrictToGenes(set.genes);
+	const std::uint64_t hash = cache_ ? restricted.contentHash() : 0;
+
+	ResultCache::Entry entry;
+	if(cache_ && cache_->load(hash, problem_, entry)) {
+		result.objective = entry.objective;
+		result.mirnas = std::move(entry.mirnas);
+		result.stats.status = "cached";
+		result.stats.optimal = true;
+		result.stats.objective = entry.objective;
+		result.stats.bound = entry.objective;
+		result.stats.gap = 0.0;
+	} else {
+		auto problem = factory_(std::move(restricted));
+		problem->setNumThreads(threads);
+		problem->solve();
+
+		result.objective = problem->objectiveValue();
+		result.mirnas = problem->selectedMirnas();
+		result.stats = problem->solveStats();
+
+		if(cache_ && ResultCache::cacheable(result.stats)) {
+			entry.objective = result.objective;
+			entry.mirnas = result.mirnas;
+			cache_->store(hash, problem_, entry);
+		}
+	}
+	result.stats.label = set.name;
+
+	// Covered genes of the set, the ids are shared with the full mappings
+	std::vector<bool> in_set(mappings_.numGenes(), false);
+	for(std::size_t g : set.genes) {
+		in_set[g] = true;
+	}
+
+	const auto& offsets = mappings_.mirnaOffsets();
+	const auto& targets = mappings_.mirnaGenes();
+	for(std::size_t m : result.mirnas) {
+		for(auto i = offsets[m]; i < offsets[m + 1]; ++i) {
+			if(in_set[targets[i]]) {
+				in_set[targets[i]] = false;
+				result.genes.push_back(targets[i]);
+			}
+		}
+	}
+
+	std::sort(result.genes.begin(), result.genes.end());
+
+	return result;
+}
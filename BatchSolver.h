@@ -0,0 +1,92 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef BATCHSOLVER_H
+#define BATCHSOLVER_H
+
+#include "ILPProblem.h"
+#include "ResultCache.h"
+#include "TargetMappings.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct GeneSet
+{
+	std::string name;
+	std::vector<std::size_t> genes;
+};
+
+/**
+ * Reads one gene set per line: its name followed by the names of its
+ * genes, separated by blanks. Genes missing from the mappings are skipped
+ * and counted in num_unknown, hence the description column of GMT files
+ * is ignored as well. Returns false if the file could not be opened.
+ */
+bool readGeneSets(const std::string& path, const TargetMappings& mappings,
+                  std::vector<GeneSet>& sets, std::size_t& num_unknown);
+
+/**
+ * Solves the same kind of ILP for many gene sets against one set of
+ * mappings. Every set is solved on the mappings restricted to its genes,
+ * which share the names and ids of the full mappings. The sets are
+ * distributed over a pool of worker threads.
+ */
+class BatchSolver
+{
+  public:
+	/// Creates the problem for the restricted mappings of one set.
+	using ProblemFactory =
+	    std::function<std::unique_ptr<ILPProblem>(TargetMappings&&)>;
+
+	struct Result
+	{
+		double objective = 0.0;
+		/// Selected miRNAs and covered genes of the set, as sorted ids of
+		/// the full mappings.
+		std::vector<std::size_t> mirnas;
+		std::vector<std::size_t> genes;
+		/// Labelled with the name of the set.
+		SolveStats stats;
+	};
+
+	BatchSolver(const TargetMappings& mappings, ProblemFactory factory);
+
+	void setNumJobs(std::size_t jobs);
+	void setVerbose(bool verbose);
+	/// Reuses optimal results of sets with the same restricted mappings,
+	/// problem describes the problem created by the factory, see
+	/// ResultCache::problemKey().
+	void setCache(const ResultCache* cache, std::string problem);
+
+	/// Returns the results in the order of sets.
+	std::vector<Result> solve(const std::vector<GeneSet>& sets) const;
+	/// Solves a single set using the given number of CPLEX threads.
+	Result solve(const GeneSet& set, int threads) const;
+
+  private:
+	const TargetMappings& mappings_;
+	ProblemFactory factory_;
+	std::size_t jobs_;
+	bool verbose_;
+	const ResultCache* cache_;
+	std::string problem_;
+};
+
+#endif // BATCHSOLVER_H
@@ -0,0 +1,329 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "CPLEXException.h"
+#include "Json.h"
+#include "MappingsParser.h"
+#include "MaxGeneCurve.h"
+#include "MaxGeneProblem.h"
+#include "Stopwatch.h"
+#include "TargetMappings.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Benchmarks the stages of a maxgene computation on a synthetic instance.
+ * Timings are written as JSON, so they can be compared across versions.
+ */
+
+namespace
+{
+struct Parameters
+{
+	std::size_t mirnas = 500;
+	std::size_t genes = 5000;
+	std::size_t mappings = 100000;
+	double mirna_exponent = 1.0;
+	double gene_exponent = 0.8;
+	std::uint64_t seed = 42;
+	std::size_t num_mirna = 10;
+	std::size_t curve_mirnas = 20;
+	std::size_t repeat = 3;
+	std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+	std::string data = "bench-mappings.txt";
+	std::string output;
+};
+
+// Uniform double in [0, 1). Unlike std::uniform_real_distribution, the
+// result is the same for every standard library.
+double uniform(std::mt19937_64& rng) { return (rng() >> 11) * 0x1.0p-53; }
+
+// Samples i with probability proportional to (i + 1)^-exponent
+class PowerLaw
+{
+  public:
+	PowerLaw(std::size_t n, double exponent) : cumulative_(n)
+	{
+		double sum = 0.0;
+		for(size_t i = 0; i < n; ++i) {
+			sum += std::pow(i + 1.0, -exponent);
+			cumulative_[i] = sum;
+		}
+	}
+
+	std::size_t operator()(std::mt19937_64& rng) const
+	{
+		const double x = uniform(rng) * cumulative_.back();
+		const auto it =
+		    std::upper_bound(cumulative_.begin(), cumulative_.end(), x);
+		return std::min<std::size_t>(it - cumulative_.begin(),
+		                             cumulative_.size() - 1);
+	}
+
+  private:
+	std::vector<double> cumulative_;
+};
+
+/**
+ * Writes a random bipartite graph whose miRNA and gene degrees both
+ * follow a power law. As in real target predictions, a few miRNAs and
+ * genes take part in most interactions. Duplicate pairs are kept.
+ */
+void generate(const Parameters& p)
+{
+	std::ofstream out(p.data);
+	if(!out) {
+		throw std::runtime_error("Could not open file '" + p.data +
+		                         "' for writing.");
+	}
+
+	std::mt19937_64 rng(p.seed);
+	const PowerLaw mirna(p.mirnas, p.mirna_exponent);
+	const PowerLaw gene(p.genes, p.gene_exponent);
+
+	for(size_t i = 0; i < p.mappings; ++i) {
+		out << "miR-" << mirna(rng) << "\tGENE" << gene(rng) << '\n';
+	}
+}
+
+struct Stage
+{
+	std::string name;
+	std::vector<double> wall;
+	std::vector<double> cpu;
+};
+
+class Stages
+{
+  public:
+	void add(const PhaseTime& time)
+	{
+		auto it = std::find_if(
+		    stages_.begin(), stages_.end(),
+		    [&time](const Stage& s) { return s.name == time.phase; });
+
+		if(it == stages_.end()) {
+			stages_.push_back(Stage{time.phase, {}, {}});
+			it = stages_.end() - 1;
+		}
+
+		it->wall.push_back(time.wall);
+		it->cpu.push_back(time.cpu);
+	}
+
+	void write(std::ostream& out) const
+	{
+		out << '[';
+		for(size_t i = 0; i < stages_.size(); ++i) {
+			const Stage& s = stages_[i];
+			out << (i > 0 ? "," : "") << "\n    {\"name\": ";
+			writeJsonString(out, s.name);
+			out << ", \"runs\": " << s.wall.size()
+			    << ", \"wall_median\": " << median(s.wall)
+			    << ", \"wall_min\": "
+			    << *std::min_element(s.wall.begin(), s.wall.end())
+			    << ", \"cpu_median\": " << median(s.cpu) << '}';
+		}
+		out << "\n  ]";
+	}
+
+  private:
+	std::vector<Stage> stages_;
+
+	static double median(std::vector<double> v)
+	{
+		std::sort(v.begin(), v.end());
+		const std::size_t n = v.size();
+		return n % 2 ? v[n / 2] : 0.5 * (v[n / 2 - 1] + v[n / 2]);
+	}
+};
+
+bool parseParameters(int argc, char* argv[], Parameters& p)
+{
+	for(int i = 1; i + 1 < argc; i += 2) {
+		const std::string name = argv[i];
+		const char* value = argv[i + 1];
+
+		try {
+			if(name == "--mirnas") {
+				p.mirnas = std::stoul(value);
+			} else if(name == "--genes") {
+				p.genes = std::stoul(value);
+			} else if(name == "--mappings") {
+				p.mappings = std::stoul(value);
+			} else if(name == "--mirna-exponent") {
+				p.mirna_exponent = std::stod(value);
+			} else if(name == "--gene-exponent") {
+				p.gene_exponent = std::stod(value);
+			} else if(name == "--seed") {
+				p.seed = std::stoull(value);
+			} else if(name == "--num-mirna") {
+				p.num_mirna = std::stoul(value);
+			} else if(name == "--curve-mirnas") {
+				p.curve_mirnas = std::stoul(value);
+			} else if(name == "--repeat") {
+				p.repeat = std::max<std::size_t>(1, std::stoul(value));
+			} else if(name == "--threads") {
+				p.threads = std::max<std::size_t>(1, std::stoul(value));
+			} else if(name == "--data") {
+				p.data = value;
+			} else if(name == "--output") {
+				p.output = value;
+			} else {
+				std::cerr << "Unknown option '" << name << "'.\n";
+				return false;
+			}
+		} catch(const std::exception& e) {
+			std::cerr << "Could not convert " << value << " to a number\n";
+			return false;
+		}
+	}
+
+	if(argc % 2 == 0) {
+		std::cerr << "Missing value for option '" << argv[argc - 1] << "'.\n";
+		return false;
+	}
+
+	if(p.mirnas == 0 || p.genes == 0) {
+		std::cerr << "The instance needs miRNAs and genes.\n";
+		return false;
+	}
+
+	return true;
+}
+
+void writeResults(std::ostream& out, const Parameters& p,
+                  const TargetMappings& mappings, std::size_t duplicates,
+                  double objective, const std::vector<std::size_t>& curve,
+                  const Stages& stages)
+{
+	out.precision(6);
+	out << "{\n  \"benchmark\": \"maxgene\",\n  \"parameters\": {"
+	    << "\"mirnas\": " << p.mirnas << ", \"genes\": " << p.genes
+	    << ", \"mappings\": " << p.mappings
+	    << ", \"mirna_exponent\": " << p.mirna_exponent
+	    << ", \"gene_exponent\": " << p.gene_exponent
+	    << ", \"seed\": " << p.seed << ", \"num_mirna\": " << p.num_mirna
+	    << ", \"curve_mirnas\": " << p.curve_mirnas
+	    << ", \"threads\": " << p.threads << "},\n  \"instance\": {"
+	    << "\"mirnas\": " << mappings.numMirnas()
+	    << ", \"genes\": " << mappings.numGenes()
+	    << ", \"unique_mappings\": " << mappings.numMappings()
+	    << ", \"duplicates\": " << duplicates << "},\n  \"results\": {"
+	    << "\"objective\": " << objective << ", \"curve\": [";
+
+	for(size_t i = 0; i < curve.size(); ++i) {
+		out << (i > 0 ? ", " : "") << curve[i];
+	}
+
+	out << "]},\n  \"stages\": ";
+	stages.write(out);
+	out << "\n}\n";
+}
+}
+
+int main(int argc, char* argv[])
+{
+	Parameters p;
+	if(!parseParameters(argc, argv, p)) {
+		std::cerr << "Usage:\n\t" << argv[0]
+		          << " [--mirnas N] [--genes N] [--mappings N]"
+		             " [--mirna-exponent X]\n\t\t[--gene-exponent X]"
+		             " [--seed N] [--num-mirna N] [--curve-mirnas N]\n\t\t"
+		             "[--repeat N] [--threads N] [--data file]"
+		             " [--output file]\n";
+		return -3;
+	}
+
+	try {
+		generate(p);
+	} catch(const std::runtime_error& e) {
+		std::cerr << e.what() << '\n';
+		return -8;
+	}
+
+	Stages stages;
+	TargetMappings mappings;
+	std::size_t duplicates = 0;
+	double objective = 0.0;
+	std::vector<std::size_t> curve;
+
+	try {
+		for(size_t run = 0; run < p.repeat; ++run) {
+			std::cerr << "Run " << run + 1 << "/" << p.repeat << '\n';
+
+			mappings = TargetMappings();
+			Stopwatch watch;
+			if(!parseMappings(p.data, mappings, p.threads)) {
+				std::cerr << "Could not open file '" << p.data
+				          << "' for reading.\n";
+				return -1;
+			}
+			stages.add(watch.phase("read_mappings"));
+
+			watch.reset();
+			duplicates = mappings.finalize(p.threads);
+			stages.add(watch.phase("finalize"));
+
+			watch.reset();
+			MaxGeneProblem problem(mappings, p.num_mirna);
+			stages.add(watch.phase("build_model"));
+			for(const auto& time : problem.buildTimes()) {
+				stages.add(time);
+			}
+
+			watch.reset();
+			problem.solve();
+			objective = problem.objectiveValue();
+			stages.add(watch.phase("solve"));
+
+			watch.reset();
+			MaxGeneCurve solver(mappings);
+			solver.setVerbose(false);
+			solver.setMaxMirnas(p.curve_mirnas);
+			curve = solver.compute();
+			stages.add(watch.phase("maxgene_curve"));
+		}
+	} catch(const CPLEXException& e) {
+		std::cerr << "Error during ILP computation: " << e.what() << std::endl;
+		return -7;
+	}
+
+	if(p.output.empty()) {
+		writeResults(std::cout, p, mappings, duplicates, objective, curve,
+		             stages);
+		return 0;
+	}
+
+	std::ofstream out(p.output);
+	if(!out) {
+		std::cerr << "Could not open file '" << p.output << "' for writing.\n";
+		return -8;
+	}
+
+	writeResults(out, p, mappings, duplicates, objective, curve, stages);
+
+	return 0;
+}
@@ -0,0 +1,233 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "BinaryMappings.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+const char magic[8] = "MMMGBIN";
+const std::uint32_t version = 2;
+
+struct Header
+{
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t reserved;
+	std::uint64_t num_mirnas;
+	std::uint64_t num_genes;
+	std::uint64_t num_mappings;
+	std::uint64_t mirna_bytes;
+	std::uint64_t gene_bytes;
+	std::uint64_t content_hash;
+};
+
+std::uint64_t padded(std::uint64_t n) { return (n + 7) & ~std::uint64_t(7); }
+
+std::uint64_t tableSize(std::uint64_t num, std::uint64_t bytes)
+{
+	return (num + 1) * sizeof(std::uint64_t) + padded(bytes);
+}
+
+template <typename T> void writeBuffer(std::ofstream& out, const Buffer<T>& b)
+{
+	const std::uint64_t bytes = b.size() * sizeof(T);
+	const char zeros[8] = {};
+
+	out.write(reinterpret_cast<const char*>(b.data()), bytes);
+	out.write(zeros, padded(bytes) - bytes);
+}
+
+void writeNames(std::ofstream& out, const NameTable& names)
+{
+	writeBuffer(out, names.offsets());
+	writeBuffer(out, names.arena());
+}
+
+// Read only memory map of a whole file
+class MappedFile
+{
+  public:
+	explicit MappedFile(const std::string& path) : data_(nullptr), size_(0)
+	{
+		const int fd = open(path.c_str(), O_RDONLY);
+		if(fd < 0) {
+			throw std::runtime_error("Could not open file '" + path +
+			                         "' for reading.");
+		}
+
+		struct stat info;
+		if(fstat(fd, &info) == 0 && info.st_size > 0) {
+			size_ = info.st_size;
+			data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+		}
+
+		close(fd);
+
+		if(data_ == nullptr || data_ == MAP_FAILED) {
+			data_ = nullptr;
+			throw std::runtime_error("Could not map file '" + path + "'.");
+		}
+	}
+
+	~MappedFile() { munmap(data_, size_); }
+
+	const char* data() const { return static_cast<const char*>(data_); }
+	std::size_t size() const { return size_; }
+
+  private:
+	void* data_;
+	std::size_t size_;
+};
+}
+
+bool isBinaryMappings(const std::string& path)
+{
+	std::ifstream in(path, std::ios::binary);
+	char buffer[sizeof(magic)];
+
+	return in.read(buffer, sizeof(buffer)) &&
+	       std::memcmp(buffer, magic, sizeof(magic)) == 0;
+}
+
+void writeBinaryMappings(const std::string& path, TargetMappings& mappings)
+{
+	mappings.finalize();
+
+	if(mappings.numMirnas() > std::numeric_limits<std::uint32_t>::max() ||
+	   mappings.numGenes() > std::numeric_limits<std::uint32_t>::max()) {
+		throw std::runtime_error("Too many miRNAs or genes.");
+	}
+
+	std::ofstream out(path, std::ios::binary);
+	if(!out) {
+		throw std::runtime_error("Could not open file '" + path +
+		                         "' for writing.");
+	}
+
+	Header header = {};
+	std::memcpy(header.magic, magic, sizeof(magic));
+	header.version = version;
+	header.num_mirnas = mappings.numMirnas();
+	header.num_genes = mappings.numGenes();
+	header.num_mappings = mappings.numMappings();
+	header.mirna_bytes = mappings.mirnaNames().arena().size();
+	header.gene_bytes = mappings.geneNames().arena().size();
+	header.content_hash = mappings.contentHash();
+
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	writeNames(out, mappings.mirnaNames());
+	writeNames(out, mappings.geneNames());
+	writeBuffer(out, mappings.geneOffsets());
+	writeBuffer(out, mappings.geneMirnas());
+	writeBuffer(out, mappings.mirnaOffsets());
+	writeBuffer(out, mappings.mirnaGenes());
+
+	if(!out) {
+		throw std::runtime_error("Error while writing '" + path + "'.");
+	}
+}
+
+void readBinaryMappings(const std::string& path, TargetMappings& mappings)
+{
+	auto file = std::make_shared<MappedFile>(path);
+
+	Header header;
+	if(file->size() < sizeof(header)) {
+		throw std::runtime_error("File '" + path + "' is truncated.");
+	}
+
+	std::memcpy(&header, file->data(), sizeof(header));
+	if(std::memcmp(header.magic, magic, sizeof(magic)) != 0) {
+		throw std::runtime_error("File '" + path +
+		                         "' is not a binary mappings file.");
+	}
+
+	if(header.version != version) {
+		throw std::runtime_error("File '" + path +
+		                         "' has an unsupported version, please "
+		                         "re-run convert.");
+	}
+
+	const std::uint64_t nnz = header.num_mappings;
+	const std::uint64_t expected =
+	    sizeof(header) + tableSize(header.num_mirnas, header.mirna_bytes) +
+	    tableSize(header.num_genes, header.gene_bytes) +
+	    tableSize(header.num_genes, nnz * sizeof(std::uint32_t)) +
+	    tableSize(header.num_mirnas, nnz * sizeof(std::uint32_t));
+
+	if(file->size() != expected) {
+		throw std::runtime_error("File '" + path + "' is truncated.");
+	}
+
+	// All sections are views into the mapped file, which is kept alive
+	// by the buffers.
+	const char* p = file->data() + sizeof(header);
+
+	auto offsets = [&p, &file](std::uint64_t n, std::uint64_t last) {
+		const auto* data = reinterpret_cast<const std::uint64_t*>(p);
+		if(data[0] != 0 || data[n] != last ||
+		   !std::is_sorted(data, data + n + 1)) {
+			throw std::runtime_error("Corrupt offset table.");
+		}
+
+		p += (n + 1) * sizeof(std::uint64_t);
+		return Buffer<std::uint64_t>(file, data, n + 1);
+	};
+
+	auto names = [&p, &file, &offsets](std::uint64_t n, std::uint64_t bytes) {
+		auto name_offsets = offsets(n, bytes);
+		Buffer<char> arena(file, p, bytes);
+		p += padded(bytes);
+		return NameTable(std::move(arena), std::move(name_offsets));
+	};
+
+	auto ids = [&p, &file, nnz](std::uint64_t bound) {
+		const auto* data = reinterpret_cast<const std::uint32_t*>(p);
+		if(std::any_of(data, data + nnz,
+		               [bound](std::uint32_t i) { return i >= bound; })) {
+			throw std::runtime_error("Corrupt mapping table.");
+		}
+
+		p += padded(nnz * sizeof(std::uint32_t));
+		return Buffer<std::uint32_t>(file, data, nnz);
+	};
+
+	mappings.mirnas_ = names(header.num_mirnas, header.mirna_bytes);
+	mappings.genes_ = names(header.num_genes, header.gene_bytes);
+	mappings.gene_offsets_ = offsets(header.num_genes, nnz);
+	mappings.gene_mirnas_ = ids(header.num_mirnas);
+	mappings.mirna_offsets_ = offsets(header.num_mirnas, nnz);
+	mappings.mirna_genes_ = ids(header.num_genes);
+	mappings.pending_.clear();
+
+	mappings.finalized_ = true;
+	mappings.hash_ = header.content_hash;
+}
@@ -0,0 +1,52 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MINMAX_BINARYMAPPINGS_H
+#define MINMAX_BINARYMAPPINGS_H
+
+#include "TargetMappings.h"
+
+#include <string>
+
+/**
+ * Preprocessed mappings in a versioned binary format. The file stores the
+ * name tables and the finalized (sorted, duplicate free) mappings in the
+ * in-memory layout of TargetMappings. Loading maps the file and uses all
+ * sections in place, only the name lookup index is rebuilt. All integers
+ * are stored in native byte order, every section is padded to 8 bytes:
+ *
+ *   header: magic "MMMGBIN", version, reserved (uint32), numbers of
+ *           miRNAs, genes and mappings, sizes of the miRNA and gene name
+ *           tables and the content hash (uint64)
+ *   miRNA name offsets (uint64, numMirnas + 1), names
+ *   gene name offsets (uint64, numGenes + 1), names
+ *   gene -> miRNA CSR: offsets (uint64, numGenes + 1), miRNA ids (uint32)
+ *   miRNA -> gene CSR: offsets (uint64, numMirnas + 1), gene ids (uint32)
+ */
+
+/// Checks whether path starts with the magic of the binary format.
+bool isBinaryMappings(const std::string& path);
+
+/// Writes the mappings, which are finalized first. Throws
+/// std::runtime_error on failure.
+void writeBinaryMappings(const std::string& path, TargetMappings& mappings);
+
+/// Replaces the contents of mappings by the contents of the file. Throws
+/// std::runtime_error if the file cannot be read or is malformed.
+void readBinaryMappings(const std::string& path, TargetMappings& mappings);
+
+#endif // MINMAX_BINARYMAPPINGS_H
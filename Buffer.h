@@ -0,0 +1,71 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MINMAX_BUFFER_H
+#define MINMAX_BUFFER_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * A read-mostly array that either owns its elements or views memory kept
+ * alive by a shared owner, e.g. a memory mapped file. Copies share their
+ * storage, which is copied before the first modification.
+ */
+template <typename T> class Buffer
+{
+  public:
+	Buffer() = default;
+	Buffer(std::vector<T> values)
+	    : owned_(std::make_shared<std::vector<T>>(std::move(values)))
+	{
+	}
+	Buffer(std::shared_ptr<const void> owner, const T* data, std::size_t size)
+	    : owner_(std::move(owner)), data_(data), size_(size)
+	{
+	}
+
+	const T* data() const { return owned_ ? owned_->data() : data_; }
+	std::size_t size() const { return owned_ ? owned_->size() : size_; }
+	bool empty() const { return size() == 0; }
+
+	const T* begin() const { return data(); }
+	const T* end() const { return data() + size(); }
+
+	const T& operator[](std::size_t i) const { return data()[i]; }
+	const T& back() const { return data()[size() - 1]; }
+
+	/// Exclusively owned storage for modifications.
+	std::vector<T>& edit()
+	{
+		if(!owned_ || owned_.use_count() > 1) {
+			owned_ = std::make_shared<std::vector<T>>(begin(), end());
+			owner_.reset();
+		}
+
+		return *owned_;
+	}
+
+  private:
+	std::shared_ptr<std::vector<T>> owned_;
+	std::shared_ptr<const void> owner_;
+	const T* data_ = nullptr;
+	std::size_t size_ = 0;
+};
+
+#endif // MINMAX_BUFFER_H
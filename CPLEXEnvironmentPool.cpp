@@ -0,0 +1,156 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "CPLEXEnvironmentPool.h"
+
+#include "CPLEXException.h"
+
+#include <string>
+#include <utility>
+
+namespace
+{
+void configure(CPXENVptr env)
+{
+	CPXsetintparam(env, CPX_PARAM_PREIND, CPX_OFF);
+}
+}
+
+CPLEXEnvironmentPool::Lease::Lease(CPLEXEnvironmentPool* pool, CPXENVptr env,
+                                   int threads)
+    : pool_(pool), env_(env), threads_(threads)
+{
+}
+
+CPLEXEnvironmentPool::Lease::Lease(Lease&& other)
+    : pool_(other.pool_), env_(other.env_), threads_(other.threads_)
+{
+	other.pool_ = nullptr;
+	other.env_ = nullptr;
+}
+
+CPLEXEnvironmentPool::Lease& CPLEXEnvironmentPool::Lease::
+operator=(Lease&& other)
+{
+	if(this != &other) {
+		release_();
+		std::swap(pool_, other.pool_);
+		std::swap(env_, other.env_);
+		std::swap(threads_, other.threads_);
+	}
+
+	return *this;
+}
+
+CPLEXEnvironmentPool::Lease::~Lease() { release_(); }
+
+int CPLEXEnvironmentPool::Lease::setNumThreads(int threads)
+{
+	if(threads == threads_) {
+		return 0;
+	}
+
+	const int status = CPXsetintparam(env_, CPX_PARAM_THREADS, threads);
+	if(status == 0) {
+		threads_ = threads;
+	}
+
+	return status;
+}
+
+void CPLEXEnvironmentPool::Lease::release_()
+{
+	if(env_) {
+		pool_->release_(env_, threads_);
+		pool_ = nullptr;
+		env_ = nullptr;
+	}
+}
+
+CPLEXEnvironmentPool::~CPLEXEnvironmentPool()
+{
+	for(auto& idle : idle_) {
+		CPXcloseCPLEX(&idle.env);
+	}
+}
+
+CPLEXEnvironmentPool& CPLEXEnvironmentPool::global()
+{
+	static CPLEXEnvironmentPool pool;
+	return pool;
+}
+
+CPLEXEnvironmentPool::Lease CPLEXEnvironmentPool::acquire(int threads)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if(!idle_.empty()) {
+			std::size_t i = idle_.size() - 1;
+			for(std::size_t j = 0; j < idle_.size(); ++j) {
+				if(idle_[j].threads == threads) {
+					i = j;
+					break;
+				}
+			}
+
+			const Environment env = idle_[i];
+			idle_.erase(idle_.begin() + i);
+
+			Lease lease(this, env.env, env.threads);
+			lease.setNumThreads(threads);
+			return lease;
+		}
+
+		++num_opened_;
+	}
+
+	int status = 0;
+	CPXENVptr env = CPXopenCPLEX(&status);
+	if(!env) {
+		const std::string message =
+		    "Could not open a CPLEX environment, status " +
+		    std::to_string(status) + ".";
+		throw CPLEXException(message.c_str());
+	}
+
+	configure(env);
+
+	Lease lease(this, env, 0);
+	lease.setNumThreads(threads);
+	return lease;
+}
+
+std::size_t CPLEXEnvironmentPool::numOpened() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return num_opened_;
+}
+
+void CPLEXEnvironmentPool::release_(CPXENVptr env, int threads)
+{
+	// Callbacks and flags refer to the borrower, which is going away
+	CPXsetinfocallbackfunc(env, nullptr, nullptr);
+	CPXsetterminate(env, nullptr);
+	CPXsetdefaults(env);
+	configure(env);
+	if(threads != 0) {
+		CPXsetintparam(env, CPX_PARAM_THREADS, threads);
+	}
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	idle_.push_back({env, threads});
+}
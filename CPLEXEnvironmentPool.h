@@ -0,0 +1,97 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MINMAX_CPLEXENVIRONMENTPOOL_H
+#define MINMAX_CPLEXENVIRONMENTPOOL_H
+
+#include <ilcplex/cplex.h>
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+/**
+ * Keeps CPLEX environments open for the lifetime of the process, such that
+ * short-lived problems do not pay for opening an environment and checking
+ * out a license each.
+ *
+ * An environment is lent to a single Lease at a time. The lease, and thus
+ * the problem holding it, owns the environment exclusively and may change
+ * its parameters, but must not share it with other threads. On return the
+ * parameters are reset to the CPLEX defaults, except for the thread count,
+ * which stays with the environment such that borrowers asking for the same
+ * count do not change it. Presolve is disabled in every environment lent.
+ */
+class CPLEXEnvironmentPool
+{
+  public:
+	class Lease
+	{
+	  public:
+		Lease() = default;
+		Lease(Lease&& other);
+		Lease& operator=(Lease&& other);
+		~Lease();
+
+		CPXENVptr get() const { return env_; }
+
+		/// Only changes the parameter if the count differs from the one
+		/// the environment carries.
+		int setNumThreads(int threads);
+
+	  private:
+		friend class CPLEXEnvironmentPool;
+
+		CPLEXEnvironmentPool* pool_ = nullptr;
+		CPXENVptr env_ = nullptr;
+		int threads_ = 0;
+
+		Lease(CPLEXEnvironmentPool* pool, CPXENVptr env, int threads);
+		void release_();
+	};
+
+	CPLEXEnvironmentPool() = default;
+	CPLEXEnvironmentPool(const CPLEXEnvironmentPool&) = delete;
+	CPLEXEnvironmentPool& operator=(const CPLEXEnvironmentPool&) = delete;
+	/// Closes the idle environments, all leases need to be returned.
+	~CPLEXEnvironmentPool();
+
+	/// The pool shared by all problems of the process.
+	static CPLEXEnvironmentPool& global();
+
+	/// Lends an idle environment, preferably one carrying the given thread
+	/// count, or opens a new one. Throws a CPLEXException if that fails.
+	Lease acquire(int threads = 0);
+
+	/// Number of environments opened so far.
+	std::size_t numOpened() const;
+
+  private:
+	struct Environment
+	{
+		CPXENVptr env;
+		int threads;
+	};
+
+	mutable std::mutex mutex_;
+	std::vector<Environment> idle_;
+	std::size_t num_opened_ = 0;
+
+	void release_(CPXENVptr env, int threads);
+};
+
+#endif // MINMAX_CPLEXENVIRONMENTPOOL_H
@@ -0,0 +1,76 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ConnectedComponents.h"
+
+#include <numeric>
+
+namespace
+{
+std::size_t findRoot(std::vector<std::size_t>& parent, std::size_t i)
+{
+	while(parent[i] != i) {
+		parent[i] = parent[parent[i]];
+		i = parent[i];
+	}
+
+	return i;
+}
+}
+
+ConnectedComponents::ConnectedComponents(const TargetMappings& mappings)
+{
+	const std::size_t num_mirnas = mappings.numMirnas();
+
+	// Union-find over miRNAs followed by genes
+	std::vector<std::size_t> parent(num_mirnas + mappings.numGenes());
+	std::iota(parent.begin(), parent.end(), 0);
+
+	for(const auto& mapping : mappings) {
+		const std::size_t a = findRoot(parent, mapping.mirna());
+		const std::size_t b = findRoot(parent, mapping.gene() + num_mirnas);
+		parent[a] = b;
+	}
+
+	const std::size_t none = parent.size();
+	std::vector<std::size_t> component(parent.size(), none);
+	std::vector<std::size_t> local_id(num_mirnas, none);
+
+	// TargetMappings::add numbers miRNAs in order of appearance, the same
+	// order is used for the index translation.
+	for(const auto& mapping : mappings) {
+		const std::size_t root = findRoot(parent, mapping.mirna());
+		if(component[root] == none) {
+			component[root] = components_.size();
+			components_.emplace_back();
+			mirnas_.emplace_back();
+		}
+
+		const std::size_t c = component[root];
+		if(local_id[mapping.mirna()] == none) {
+			local_id[mapping.mirna()] = mirnas_[c].size();
+			mirnas_[c].push_back(mapping.mirna());
+		}
+
+		components_[c].add(mappings.mirna(mapping.mirna()),
+		                   mappings.gene(mapping.gene()));
+	}
+
+	for(auto& component : components_) {
+		component.finalize();
+	}
+}
@@ -0,0 +1,54 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MINMAX_CONNECTEDCOMPONENTS_H
+#define MINMAX_CONNECTEDCOMPONENTS_H
+
+#include "TargetMappings.h"
+
+#include <vector>
+
+/**
+ * Splits the bipartite miRNA-gene graph into its connected components.
+ * Coverage problems decompose over the components, which can thus be
+ * solved independently.
+ */
+class ConnectedComponents
+{
+  public:
+	explicit ConnectedComponents(const TargetMappings& mappings);
+
+	std::size_t size() const { return components_.size(); }
+
+	const TargetMappings& mappings(std::size_t i) const
+	{
+		return components_[i];
+	}
+
+	/// Original index of every miRNA of component i, ordered by the
+	/// miRNA indices used by mappings(i).
+	const std::vector<std::size_t>& mirnas(std::size_t i) const
+	{
+		return mirnas_[i];
+	}
+
+  private:
+	std::vector<TargetMappings> components_;
+	std::vector<std::vector<std::size_t>> mirnas_;
+};
+
+#endif // MINMAX_CONNECTEDCOMPONENTS_H
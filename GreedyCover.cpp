@@ -0,0 +1,281 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "GreedyCover.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+
+GreedyCover::GreedyCover(const InstanceReduction& instance)
+    : gene_weights_(instance.numGenes()),
+      multiplicities_(instance.numMirnas()),
+      offsets_(instance.numMirnas() + 1, 0)
+{
+	for(size_t i = 0; i < gene_weights_.size(); ++i) {
+		gene_weights_[i] = instance.geneWeight(i);
+	}
+
+	for(size_t i = 0; i < multiplicities_.size(); ++i) {
+		multiplicities_[i] = instance.mirnaMultiplicity(i);
+	}
+
+	// Build miRNA -> gene adjacency lists in CSR format
+	for(const auto& mapping : instance) {
+		++offsets_[mapping.mirna() + 1];
+	}
+
+	for(size_t i = 1; i < offsets_.size(); ++i) {
+		offsets_[i] += offsets_[i - 1];
+	}
+
+	targets_.resize(offsets_.back());
+	std::vector<std::size_t> pos(offsets_.begin(), offsets_.end() - 1);
+	for(const auto& mapping : instance) {
+		targets_[pos[mapping.mirna()]++] = mapping.gene();
+	}
+}
+
+std::size_t GreedyCover::gain_(std::size_t mirna,
+                               const std::vector<bool>& covered) const
+{
+	std::size_t result = 0;
+	for(size_t i = offsets_[mirna]; i < offsets_[mirna + 1]; ++i) {
+		if(!covered[targets_[i]]) {
+			result += gene_weights_[targets_[i]];
+		}
+	}
+
+	return result;
+}
+
+template <typename Continue>
+void GreedyCover::run_(std::vector<std::size_t>& selection,
+                       Continue cont) const
+{
+	const std::size_t num_mirnas = offsets_.size() - 1;
+	std::vector<bool> covered(gene_weights_.size(), false);
+	std::vector<std::size_t> used(num_mirnas, 0);
+	std::size_t num_covered = 0;
+
+	auto select = [&](std::size_t m) {
+		++used[m];
+		for(size_t i = offsets_[m]; i < offsets_[m + 1]; ++i) {
+			if(!covered[targets_[i]]) {
+				covered[targets_[i]] = true;
+				num_covered += gene_weights_[targets_[i]];
+			}
+		}
+	};
+
+	for(std::size_t m : selection) {
+		select(m);
+	}
+
+	// Entries are (gain, miRNA) pairs, gains may be outdated
+	std::priority_queue<std::pair<std::size_t, std::size_t>> queue;
+	for(size_t m = 0; m < num_mirnas; ++m) {
+		if(used[m] < multiplicities_[m]) {
+			queue.emplace(gain_(m, covered), m);
+		}
+	}
+
+	while(!queue.empty()) {
+		const auto top = queue.top();
+		queue.pop();
+
+		const std::size_t gain = gain_(top.second, covered);
+		if(gain < top.first) {
+			queue.emplace(gain, top.second);
+			continue;
+		}
+
+		if(!cont(selection.size(), num_covered, gain)) {
+			break;
+		}
+
+		select(top.second);
+		selection.push_back(top.second);
+
+		// Further copies of a merged miRNA cover nothing new
+		if(used[top.second] < multiplicities_[top.second]) {
+			queue.emplace(0, top.second);
+		}
+	}
+}
+
+std::vector<std::size_t>
+GreedyCover::maxCoverage(std::size_t k,
+                         std::vector<std::size_t> selection) const
+{
+	run_(selection, [k](std::size_t num_selected, std::size_t, std::size_t) {
+		return num_selected < k;
+	});
+
+	return selection;
+}
+
+std::vector<std::size_t>
+GreedyCover::setCover(std::size_t num_genes,
+                      std::vector<std::size_t> selection) const
+{
+	run_(selection, [num_genes](std::size_t, std::size_t num_covered,
+	                            std::size_t gain) {
+		return num_covered < num_genes && gain > 0;
+	});
+
+	return selection;
+}
+
+std::vector<std::size_t>
+GreedyCover::weightedCoverage(double mirna_weight, double gene_weight,
+                              std::vector<std::size_t> selection) const
+{
+	run_(selection, [mirna_weight, gene_weight](std::size_t, std::size_t,
+	                                            std::size_t gain) {
+		return gene_weight * gain > mirna_weight;
+	});
+
+	return selection;
+}
+
+std::vector<std::size_t>
+GreedyCover::prune(double mirna_weight, double gene_weight,
+                   std::vector<std::size_t> selection) const
+{
+	// Number of selected regulators of every gene
+	std::vector<std::size_t> count(gene_weights_.size(), 0);
+	for(std::size_t m : selection) {
+		for(size_t i = offsets_[m]; i < offsets_[m + 1]; ++i) {
+			++count[targets_[i]];
+		}
+	}
+
+	// Removing a miRNA changes the exclusive coverage of the remaining
+	// ones, hence they are re-evaluated after every removal.
+	std::vector<std::size_t> result;
+	result.reserve(selection.size());
+	for(std::size_t m : selection) {
+		std::size_t exclusive = 0;
+		for(size_t i = offsets_[m]; i < offsets_[m + 1]; ++i) {
+			if(count[targets_[i]] == 1) {
+				exclusive += gene_weights_[targets_[i]];
+			}
+		}
+
+		if(gene_weight * exclusive > mirna_weight) {
+			result.push_back(m);
+			continue;
+		}
+
+		for(size_t i = offsets_[m]; i < offsets_[m + 1]; ++i) {
+			--count[targets_[i]];
+		}
+	}
+
+	return result;
+}
+
+std::vector<std::size_t>
+GreedyCover::removalOrder(std::vector<std::size_t> selection) const
+{
+	std::vector<std::size_t> count(gene_weights_.size(), 0);
+	for(std::size_t m : selection) {
+		for(size_t i = offsets_[m]; i < offsets_[m + 1]; ++i) {
+			++count[targets_[i]];
+		}
+	}
+
+	auto loss = [&](std::size_t m) {
+		std::size_t result = 0;
+		for(size_t i = offsets_[m]; i < offsets_[m + 1]; ++i) {
+			if(count[targets_[i]] == 1) {
+				result += gene_weights_[targets_[i]];
+			}
+		}
+		return result;
+	};
+
+	// Entries are (loss, position) pairs. Losses can only grow as miRNAs
+	// are removed, hence stale entries are re-evaluated lazily.
+	using Entry = std::pair<std::size_t, std::size_t>;
+	std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+	for(size_t i = 0; i < selection.size(); ++i) {
+		queue.emplace(loss(selection[i]), i);
+	}
+
+	std::vector<std::size_t> order;
+	order.reserve(selection.size());
+	while(!queue.empty()) {
+		const auto top = queue.top();
+		queue.pop();
+
+		const std::size_t m = selection[top.second];
+		const std::size_t current = loss(m);
+		if(current > top.first) {
+			queue.emplace(current, top.second);
+			continue;
+		}
+
+		order.push_back(m);
+		for(size_t i = offsets_[m]; i < offsets_[m + 1]; ++i) {
+			--count[targets_[i]];
+		}
+	}
+
+	std::reverse(order.begin(), order.end());
+
+	return order;
+}
+
+std::size_t
+GreedyCover::coveredWeight(const std::vector<std::size_t>& selection) const
+{
+	std::vector<bool> covered(gene_weights_.size(), false);
+	std::size_t result = 0;
+	for(std::size_t m : selection) {
+		for(size_t i = offsets_[m]; i < offsets_[m + 1]; ++i) {
+			if(!covered[targets_[i]]) {
+				covered[targets_[i]] = true;
+				result += gene_weights_[targets_[i]];
+			}
+		}
+	}
+
+	return result;
+}
+
+std::vector<std::size_t>
+GreedyCover::prefixWeights(const std::vector<std::size_t>& sequence) const
+{
+	std::vector<bool> covered(gene_weights_.size(), false);
+	std::vector<std::size_t> result(1, 0);
+	result.reserve(sequence.size() + 1);
+	for(std::size_t m : sequence) {
+		std::size_t weight = result.back();
+		for(size_t i = offsets_[m]; i < offsets_[m + 1]; ++i) {
+			if(!covered[targets_[i]]) {
+				covered[targets_[i]] = true;
+				weight += gene_weights_[targets_[i]];
+			}
+		}
+		result.push_back(weight);
+	}
+
+	return result;
+}
@@ -0,0 +1,87 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MINMAX_GREEDYCOVER_H
+#define MINMAX_GREEDYCOVER_H
+
+#include "InstanceReduction.h"
+
+#include <vector>
+
+/**
+ * Lazy greedy heuristics for the coverage problems. miRNAs are picked by
+ * their marginal gain, i.e. the weight of their not yet covered targets.
+ * As gains can only decrease, stale priority queue entries are
+ * re-evaluated only when they reach the top of the queue.
+ *
+ * Selections are given in terms of the reduced instance and may contain
+ * a miRNA up to its multiplicity.
+ */
+class GreedyCover
+{
+  public:
+	explicit GreedyCover(const InstanceReduction& instance);
+
+	/// Extends the given selection to (at most) k miRNAs.
+	std::vector<std::size_t>
+	maxCoverage(std::size_t k,
+	            std::vector<std::size_t> selection = {}) const;
+
+	/// Extends the given selection until it covers genes of weight
+	/// num_genes.
+	std::vector<std::size_t>
+	setCover(std::size_t num_genes,
+	         std::vector<std::size_t> selection = {}) const;
+
+	/// Extends the given selection as long as the gain of the next miRNA
+	/// outweighs its cost.
+	std::vector<std::size_t>
+	weightedCoverage(double mirna_weight, double gene_weight,
+	                 std::vector<std::size_t> selection = {}) const;
+
+	/// Drops miRNAs from the selection whose exclusively covered genes do
+	/// not outweigh their cost.
+	std::vector<std::size_t> prune(double mirna_weight, double gene_weight,
+	                               std::vector<std::size_t> selection) const;
+
+	/// Reorders the selection such that every prefix follows from the next
+	/// longer one by dropping the miRNA whose removal uncovers the least
+	/// weight.
+	std::vector<std::size_t>
+	removalOrder(std::vector<std::size_t> selection) const;
+
+	/// Total weight of the genes covered by the selection.
+	std::size_t coveredWeight(const std::vector<std::size_t>& selection) const;
+	/// Covered weight of every prefix of the sequence, including the empty
+	/// one.
+	std::vector<std::size_t>
+	prefixWeights(const std::vector<std::size_t>& sequence) const;
+
+  private:
+	std::vector<std::size_t> gene_weights_;
+	std::vector<std::size_t> multiplicities_;
+	std::vector<std::size_t> offsets_;
+	std::vector<std::size_t> targets_;
+
+	std::size_t gain_(std::size_t mirna,
+	                  const std::vector<bool>& covered) const;
+
+	template <typename Continue>
+	void run_(std::vector<std::size_t>& selection, Continue cont) const;
+};
+
+#endif // MINMAX_GREEDYCOVER_H
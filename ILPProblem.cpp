@@ -19,17 +19,19 @@
 
 #include "CPLEXException.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <cassert>
+#include <numeric>
+#include <thread>
 
 ILPProblem::~ILPProblem()
 {
+	// The environment returns to the pool afterwards
 	if(lp_) {
 		CPXfreeprob(env_, &lp_);
 	}
-
-	if(env_) {
-		CPXcloseCPLEX(&env_);
-	}
 }
 
 void ILPProblem::handleCPLEXError_(int status)
@@ -47,13 +49,44 @@ void ILPProblem::handleCPLEXError_(int status)
 	}
 }
 
+namespace
+{
+// Upper bound on the non-zeros passed to a single CPXaddrows call
+const std::size_t MAX_CHUNK_NONZEROS = std::size_t(1) << 20;
+
+std::unique_ptr<const TargetMappings> finalized(TargetMappings mappings)
+{
+	mappings.finalize();
+	return std::unique_ptr<const TargetMappings>(
+	    new TargetMappings(std::move(mappings)));
+}
+}
+
 ILPProblem::ILPProblem(const TargetMappings& mappings)
-    : mappings_(mappings), env_(nullptr), lp_(nullptr)
+    : owned_mappings_(mappings.isFinalized() ? nullptr : finalized(mappings)),
+      mappings_(owned_mappings_ ? *owned_mappings_ : mappings),
+      env_(nullptr),
+      lp_(nullptr),
+      objective_(0.0),
+      lp_bound_(0.0),
+      first_incumbent_(-1.0),
+      first_report_(true),
+      last_incumbent_(0.0),
+      known_bound_(std::numeric_limits<double>::infinity())
 {
 }
 
 ILPProblem::ILPProblem(TargetMappings&& mappings)
-    : mappings_(std::move(mappings)), env_(nullptr), lp_(nullptr)
+    : owned_mappings_(finalized(std::move(mappings))),
+      mappings_(*owned_mappings_),
+      env_(nullptr),
+      lp_(nullptr),
+      objective_(0.0),
+      lp_bound_(0.0),
+      first_incumbent_(-1.0),
+      first_report_(true),
+      last_incumbent_(0.0),
+      known_bound_(std::numeric_limits<double>::infinity())
 {
 }
 
@@ -63,64 +96,293 @@ size_t ILPProblem::numConstraints() const { return CPXgetnumrows(env_, lp_); }
 
 size_t ILPProblem::numNonZero() const { return CPXgetnumnz(env_, lp_); }
 
+void ILPProblem::setNumThreads(int threads)
+{
+	handleCPLEXError_(environment_.setNumThreads(threads));
+}
+
+int ILPProblem::threadsPerJob(std::size_t jobs)
+{
+	const unsigned int cores =
+	    std::max(1u, std::thread::hardware_concurrency());
+	return std::max<int>(1, cores / std::max<std::size_t>(jobs, 1));
+}
+
+void ILPProblem::setTerminationFlag(volatile int* flag)
+{
+	handleCPLEXError_(CPXsetterminate(env_, flag));
+}
+
+void ILPProblem::setLimits(const SolveLimits& limits)
+{
+	// Restore the CPLEX defaults for disabled limits
+	handleCPLEXError_(CPXsetdblparam(env_, CPX_PARAM_TILIM,
+	                                 limits.time > 0.0 ? limits.time : 1e75));
+	handleCPLEXError_(CPXsetdblparam(env_, CPX_PARAM_EPGAP,
+	                                 limits.gap > 0.0 ? limits.gap : 1e-4));
+}
+
+void ILPProblem::setIncumbentCallback(IncumbentCallback callback)
+{
+	std::lock_guard<std::mutex> lock(incumbent_mutex_);
+	incumbent_callback_ = std::move(callback);
+}
+
 void ILPProblem::createProblem_()
 {
 	int status = 0;
-	env_ = CPXopenCPLEX(&status);
-	handleCPLEXError_(status);
+	environment_ = CPLEXEnvironmentPool::global().acquire();
+	env_ = environment_.get();
 
-	CPXsetintparam(env_, CPX_PARAM_PREIND, CPX_OFF);
+	handleCPLEXError_(
+	    CPXsetinfocallbackfunc(env_, &ILPProblem::incumbentCallback_, this));
 	lp_ = CPXcreateprob(env_, &status, "MinMax");
 	handleCPLEXError_(status);
 
-	mappings_.finalize();
+	build_times_.clear();
+
+	Stopwatch watch;
+	instance_.reset(new InstanceReduction(mappings_));
+	greedy_.reset(new GreedyCover(*instance_));
+	build_times_.push_back(watch.phase("reduction"));
+
+	watch.reset();
 	createObjectiveFunction_();
 	createConstraints_();
+	build_times_.push_back(watch.phase("formulation"));
+}
+
+void ILPProblem::createColumns_(const std::vector<double>& objective)
+{
+	const std::size_t num_mirnas = instance_->numMirnas();
+	const std::size_t nvar = num_mirnas + instance_->numGenes();
+
+	// Merged miRNAs may be selected once for every member
+	std::vector<char> ctype(nvar, 'B');
+	std::vector<double> ub(nvar, 1.0);
+	for(size_t i = 0; i < num_mirnas; ++i) {
+		ub[i] = instance_->mirnaMultiplicity(i);
+		if(ub[i] > 1.0) {
+			ctype[i] = 'I';
+		}
+	}
+
+	int status = CPXnewcols(env_, lp_, nvar, &objective[0], nullptr, &ub[0],
+	                        &ctype[0], nullptr);
+	handleCPLEXError_(status);
 }
 
 void ILPProblem::createMappingConstraints_()
 {
-	const size_t num_constr = mappings_.numGenes();
-	const size_t num_indices = mappings_.numMappings() + mappings_.numGenes();
-	std::vector<int> indices(num_indices);
-	std::vector<double> row(num_indices);
+	Stopwatch watch;
+
+	// One row per reduced gene: -g + sum of its regulators >= 0. The rows
+	// are read directly off the CSR adjacency, with the gene variable
+	// inserted in front of every adjacency list. They are added in chunks
+	// of bounded size, such that the buffers stay small compared to the
+	// model CPLEX builds from them.
+	const InstanceReduction& instance = *instance_;
+	const auto& offsets = instance.geneOffsets();
+	const auto& regulators = instance.geneMirnas();
+	const size_t num_constr = instance.numGenes();
+	const size_t num_indices = instance.numMappings() + instance.numGenes();
+
+	std::vector<int> indices;
+	std::vector<double> row;
+	std::vector<int> rmatbeg;
+	indices.reserve(std::min(num_indices, MAX_CHUNK_NONZEROS));
+	row.reserve(indices.capacity());
+
+	for(size_t first = 0; first < num_constr;) {
+		indices.clear();
+		row.clear();
+		rmatbeg.clear();
+
+		// A single row longer than the chunk size forms its own chunk
+		size_t g = first;
+		for(; g < num_constr; ++g) {
+			const size_t length = offsets[g + 1] - offsets[g] + 1;
+			if(g > first && indices.size() + length > MAX_CHUNK_NONZEROS) {
+				break;
+			}
+
+			rmatbeg.push_back(indices.size());
+			indices.push_back(g + instance.numMirnas());
+			row.push_back(-1.0);
+			indices.insert(indices.end(), regulators.begin() + offsets[g],
+			               regulators.begin() + offsets[g + 1]);
+			row.resize(indices.size(), 1.0);
+		}
 
-	std::vector<int> rmatbeg(num_constr + 1, 0);
-	std::vector<double> rhs(num_constr, 0.0);
-	std::vector<char> sense(num_constr, 'G');
+		const std::vector<double> rhs(g - first, 0.0);
+		const std::vector<char> sense(g - first, 'G');
+		int status = CPXaddrows(env_, lp_, 0, g - first, indices.size(),
+		                        &rhs[0], &sense[0], &rmatbeg[0], &indices[0],
+		                        &row[0], 0, 0);
+		handleCPLEXError_(status);
 
-	size_t cur_gene = 0;
-	size_t cur_constr = 0;
-	size_t cur_index = 1;
+		first = g;
+	}
 
-	indices[0] = mappings_.numMirnas();
-	row[0] = -1.0;
-	for(const auto& mapping : mappings_) {
-		if(mapping.gene() != cur_gene) {
-			cur_gene = mapping.gene();
-			indices[cur_index] = cur_gene + mappings_.numMirnas();
-			row[cur_index] = -1.0;
-			rmatbeg[++cur_constr] = cur_index++;
-		}
+	build_times_.push_back(watch.phase("mapping_constraints"));
+}
 
-		indices[cur_index] = mapping.mirna();
-		row[cur_index] = 1.0;
-		++cur_index;
+void ILPProblem::clearMipStarts_()
+{
+	const int num_starts = CPXgetnummipstarts(env_, lp_);
+	if(num_starts > 0) {
+		handleCPLEXError_(CPXdelmipstarts(env_, lp_, 0, num_starts - 1));
 	}
+}
 
-	rmatbeg[++cur_constr] = cur_index;
+void ILPProblem::addMipStart_(const std::vector<std::size_t>& mirnas)
+{
+	const size_t num_mirnas = instance_->numMirnas();
+	const size_t num_variables = num_mirnas + instance_->numGenes();
+	std::vector<double> values(num_variables, 0.0);
 
-	int status = CPXaddrows(env_, lp_, 0, num_constr, num_indices, &rhs[0],
-	                        &sense[0], &rmatbeg[0], &indices[0], &row[0], 0, 0);
+	for(size_t m : mirnas) {
+		values[m] += 1.0;
+	}
 
+	// A gene is covered iff one of its regulators has been selected
+	for(const auto& mapping : *instance_) {
+		if(values[mapping.mirna()] > 0.5) {
+			values[mapping.gene() + num_mirnas] = 1.0;
+		}
+	}
+
+	std::vector<int> indices(num_variables);
+	std::iota(indices.begin(), indices.end(), 0);
+
+	const int beg = 0;
+	const int effort = CPX_MIPSTART_CHECKFEAS;
+	int status =
+	    CPXaddmipstarts(env_, lp_, 1, num_variables, &beg, &indices[0],
+	                    &values[0], &effort, nullptr);
 	handleCPLEXError_(status);
 }
 
+void ILPProblem::setLowerCutoff_(double cutoff)
+{
+	handleCPLEXError_(CPXsetdblparam(env_, CPX_PARAM_CUTLO, cutoff));
+}
+
+void ILPProblem::setKnownBound_(double bound) { known_bound_ = bound; }
+
+double ILPProblem::objectiveValue() const { return objective_; }
+
+const std::vector<std::size_t>& ILPProblem::selectedMirnas() const
+{
+	return selected_mirnas_;
+}
+
+const InstanceReduction& ILPProblem::reducedInstance() const
+{
+	return *instance_;
+}
+
+const std::vector<PhaseTime>& ILPProblem::buildTimes() const
+{
+	return build_times_;
+}
+
+const SolveStats& ILPProblem::solveStats() const { return solve_stats_; }
+
+void ILPProblem::recordSolveStats_()
+{
+	solve_stats_ = SolveStats();
+	solve_stats_.wall = solve_watch_.wall();
+	solve_stats_.cpu = solve_watch_.cpu();
+	solve_stats_.peak_rss = peakRss();
+	solve_stats_.nodes = CPXgetnodecnt(env_, lp_);
+	solve_stats_.first_incumbent = first_incumbent_;
+
+	if(CPXgetmiprelgap(env_, lp_, &solve_stats_.gap) != 0) {
+		solve_stats_.gap = -1.0;
+	}
+
+	if(CPXgetobjval(env_, lp_, &solve_stats_.objective) != 0) {
+		solve_stats_.objective = 0.0;
+	}
+
+	if(CPXgetbestobjval(env_, lp_, &solve_stats_.bound) != 0) {
+		solve_stats_.bound = 0.0;
+	}
+
+	const int status = CPXgetstat(env_, lp_);
+	solve_stats_.optimal =
+	    status == CPXMIP_OPTIMAL || status == CPXMIP_OPTIMAL_TOL;
+
+	char buffer[CPXMESSAGEBUFSIZE];
+	if(CPXgetstatstring(env_, status, buffer)) {
+		solve_stats_.status = buffer;
+	}
+
+	// A solve stopped at the known bound is optimal nonetheless
+	if(solve_stats_.gap >= 0.0 && solve_stats_.bound > known_bound_) {
+		solve_stats_.bound = known_bound_;
+		if(solve_stats_.objective >= known_bound_ - 1e-6) {
+			solve_stats_.optimal = true;
+			solve_stats_.status = "integer optimal, known bound reached";
+			solve_stats_.gap = 0.0;
+		} else {
+			solve_stats_.gap = (known_bound_ - solve_stats_.objective) /
+			                   (1e-10 + std::abs(solve_stats_.objective));
+		}
+	}
+}
+
+int CPXPUBLIC ILPProblem::incumbentCallback_(CPXCENVptr env, void* cbdata,
+                                             int wherefrom, void* handle)
+{
+	auto* problem = static_cast<ILPProblem*>(handle);
+
+	int feasible = 0;
+	if(CPXgetcallbackinfo(env, cbdata, wherefrom, CPX_CALLBACK_INFO_MIP_FEAS,
+	                      &feasible) != 0 ||
+	   !feasible) {
+		return 0;
+	}
+
+	const double seconds = problem->solve_watch_.wall();
+	double none = -1.0;
+	problem->first_incumbent_.compare_exchange_strong(none, seconds);
+
+	double objective = 0.0;
+	double bound = 0.0;
+	if(CPXgetcallbackinfo(env, cbdata, wherefrom,
+	                      CPX_CALLBACK_INFO_BEST_INTEGER, &objective) != 0 ||
+	   CPXgetcallbackinfo(env, cbdata, wherefrom,
+	                      CPX_CALLBACK_INFO_BEST_REMAINING, &bound) != 0) {
+		return 0;
+	}
+
+	bound = std::min(bound, problem->known_bound_);
+
+	{
+		std::lock_guard<std::mutex> lock(problem->incumbent_mutex_);
+		if(problem->incumbent_callback_ &&
+		   (problem->first_report_ ||
+		    objective != problem->last_incumbent_)) {
+			problem->first_report_ = false;
+			problem->last_incumbent_ = objective;
+			problem->incumbent_callback_(objective, bound, seconds);
+		}
+	}
+
+	// A non-zero return value stops the optimization
+	return objective >= problem->known_bound_ - 1e-6 ? 1 : 0;
+}
+
 bool ILPProblem::checkSolution_(const std::vector<double>& row) const
 {
 	const double tol = 1e-4;
-	for(double d : row) {
-		if(d < -tol || (d > 1.0 + tol)) {
+	for(size_t i = 0; i < row.size(); ++i) {
+		const double ub = i < instance_->numMirnas()
+		                      ? instance_->mirnaMultiplicity(i)
+		                      : 1.0;
+		if(row[i] < -tol || (row[i] > ub + tol)) {
 			return false;
 		}
 	}
@@ -130,31 +392,195 @@ bool ILPProblem::checkSolution_(const std::vector<double>& row) const
 
 ILPProblem::Result ILPProblem::solve()
 {
+	solve_watch_.reset();
+	first_incumbent_ = -1.0;
+	{
+		std::lock_guard<std::mutex> lock(incumbent_mutex_);
+		first_report_ = true;
+	}
+
 	int status = CPXmipopt(env_, lp_);
 	handleCPLEXError_(status);
+	recordSolveStats_();
 
-	const size_t num_variables = mappings_.numMirnas() + mappings_.numGenes();
+	// Limits and termination leave the best incumbent, if there is one
+	const size_t num_variables = instance_->numMirnas() + instance_->numGenes();
 	std::vector<double> row(num_variables, -1.0);
-	status = CPXgetx(env_, lp_, &row[0], 0, num_variables - 1);
+	if(CPXgetx(env_, lp_, &row[0], 0, num_variables - 1) != 0) {
+		const std::string message =
+		    "No solution found, CPLEX status: " + solve_stats_.status;
+		throw CPLEXException(message.c_str());
+	}
 
 	assert(checkSolution_(row));
 
-	handleCPLEXError_(status);
+	objective_ = solve_stats_.objective;
 
+	std::vector<std::size_t> reduced;
+	for(size_t i = 0; i < instance_->numMirnas(); ++i) {
+		const auto count = static_cast<std::size_t>(row[i] + 0.5);
+		reduced.insert(reduced.end(), count, i);
+	}
+
+	return makeResult_(reduced);
+}
+
+ILPProblem::Result
+ILPProblem::makeResult_(const std::vector<std::size_t>& reduced)
+{
 	std::vector<std::string> mirnas;
 	std::vector<std::string> genes;
 
-	for(size_t i = 0; i < mappings_.numMirnas(); ++i) {
-		if(row[i] > 0.5) {
-			mirnas.push_back(mappings_.mirna(i));
+	selected_mirnas_ = instance_->expandMirnas(reduced);
+
+	std::vector<bool> selected(mappings_.numMirnas(), false);
+	for(std::size_t m : selected_mirnas_) {
+		selected[m] = true;
+		mirnas.emplace_back(mappings_.mirna(m));
+	}
+
+	// Report every covered gene, objectives that do not reward coverage
+	// leave the gene variables of surplus genes at zero.
+	std::vector<bool> covered(mappings_.numGenes(), false);
+	for(const auto& mapping : mappings_) {
+		if(selected[mapping.mirna()]) {
+			covered[mapping.gene()] = true;
 		}
 	}
 
 	for(size_t i = 0; i < mappings_.numGenes(); ++i) {
-		if(row[i + mappings_.numMirnas()] > 0.5) {
-			genes.push_back(mappings_.gene(i));
+		if(covered[i]) {
+			genes.emplace_back(mappings_.gene(i));
 		}
 	}
 
 	return {std::move(mirnas), std::move(genes)};
 }
+
+ILPProblem::Result ILPProblem::solveApproximately(std::size_t rounds,
+                                                  std::uint64_t seed)
+{
+	solve_watch_.reset();
+	first_incumbent_ = -1.0;
+
+	// Relax a copy, such that the MIP and its starts stay intact
+	int status = 0;
+	CPXLPptr relaxation = CPXcloneprob(env_, lp_, &status);
+	handleCPLEXError_(status);
+
+	const size_t num_mirnas = instance_->numMirnas();
+	std::vector<double> x(num_mirnas, 0.0);
+
+	status = CPXchgprobtype(env_, relaxation, CPXPROB_LP);
+	if(!status) {
+		status = CPXlpopt(env_, relaxation);
+	}
+	if(!status) {
+		status = CPXgetobjval(env_, relaxation, &lp_bound_);
+	}
+	if(!status) {
+		status = CPXgetx(env_, relaxation, &x[0], 0, num_mirnas - 1);
+	}
+
+	CPXfreeprob(env_, &relaxation);
+	handleCPLEXError_(status);
+
+	const bool maximize = CPXgetobjsen(env_, lp_) == CPX_MAX;
+	std::mt19937_64 rng(seed);
+	std::vector<std::size_t> best;
+	for(std::size_t r = 0; r < std::max<std::size_t>(rounds, 1); ++r) {
+		std::vector<std::size_t> selection = round_(x, rng);
+		const double value = evaluate_(selection);
+		if(r == 0 || (maximize ? value > objective_ : value < objective_)) {
+			objective_ = value;
+			best = std::move(selection);
+		}
+	}
+
+	solve_stats_ = SolveStats();
+	solve_stats_.wall = solve_watch_.wall();
+	solve_stats_.cpu = solve_watch_.cpu();
+	solve_stats_.peak_rss = peakRss();
+	solve_stats_.status = "rounded lp relaxation";
+	solve_stats_.objective = objective_;
+	solve_stats_.bound = lp_bound_;
+	solve_stats_.gap = std::abs(lp_bound_ - objective_) /
+	                   (1e-10 + std::abs(objective_));
+
+	return makeResult_(best);
+}
+
+double ILPProblem::lpBound() const { return lp_bound_; }
+
+std::vector<std::size_t>
+ILPProblem::roundIndependently_(const std::vector<double>& x,
+                                std::mt19937_64& rng) const
+{
+	std::uniform_real_distribution<double> coin(0.0, 1.0);
+	std::vector<std::size_t> selection;
+	for(size_t i = 0; i < x.size(); ++i) {
+		const double ub = instance_->mirnaMultiplicity(i);
+		const double value = std::min(std::max(x[i], 0.0), ub);
+		auto count = static_cast<std::size_t>(value + 1e-9);
+		if(coin(rng) < value - count) {
+			++count;
+		}
+
+		selection.insert(selection.end(), count, i);
+	}
+
+	return selection;
+}
+
+std::vector<std::size_t>
+ILPProblem::roundDependently_(const std::vector<double>& x,
+                              std::mt19937_64& rng) const
+{
+	const double eps = 1e-9;
+	std::uniform_real_distribution<double> coin(0.0, 1.0);
+	std::vector<std::size_t> selection;
+	std::vector<std::pair<std::size_t, double>> fractional;
+	for(size_t i = 0; i < x.size(); ++i) {
+		const double ub = instance_->mirnaMultiplicity(i);
+		const double value = std::min(std::max(x[i], 0.0), ub);
+		const auto count = static_cast<std::size_t>(value + eps);
+		selection.insert(selection.end(), count, i);
+
+		if(value - count > eps) {
+			fractional.emplace_back(i, value - count);
+		}
+	}
+
+	// Pipage step: shift mass between two fractional values until one of
+	// them becomes integral. The sum is preserved and every value keeps
+	// its expectation.
+	while(fractional.size() > 1) {
+		auto& a = fractional[fractional.size() - 2];
+		auto& b = fractional.back();
+		const double up = std::min(1.0 - a.second, b.second);
+		const double down = std::min(a.second, 1.0 - b.second);
+		if(coin(rng) * (up + down) < down) {
+			a.second += up;
+			b.second -= up;
+		} else {
+			a.second -= down;
+			b.second += down;
+		}
+
+		for(auto* p : {&b, &a}) {
+			if(p->second > 1.0 - eps || p->second < eps) {
+				if(p->second > 0.5) {
+					selection.push_back(p->first);
+				}
+				std::swap(*p, fractional.back());
+				fractional.pop_back();
+			}
+		}
+	}
+
+	if(!fractional.empty() && coin(rng) < fractional.back().second) {
+		selection.push_back(fractional.back().first);
+	}
+
+	return selection;
+}
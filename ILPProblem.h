@@ -18,42 +18,185 @@
 #ifndef ILPPROBLEM_H
 #define ILPPROBLEM_H
 
+#include "CPLEXEnvironmentPool.h"
+#include "GreedyCover.h"
+#include "InstanceReduction.h"
+#include "Stopwatch.h"
 #include "TargetMappings.h"
 
 #include <ilcplex/cplex.h>
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
 #include <vector>
 #include <utility>
 
+/// Statistics of a single call to ILPProblem::solve().
+struct SolveStats
+{
+	/// Context set by the caller, e.g. the name of a gene set.
+	std::string label;
+	/// Parameter of curve computations, -1 for single solves.
+	long k = -1;
+
+	std::string status;
+	double wall = 0.0;
+	/// CPU time of the whole process, including concurrent solves.
+	double cpu = 0.0;
+	/// Peak resident set size of the process after the solve, in kB.
+	long peak_rss = 0;
+	long nodes = 0;
+	/// Whether the solution was proven optimal within the gap limit.
+	bool optimal = false;
+	/// Objective of the returned solution and best bound, 0 if none.
+	double objective = 0.0;
+	double bound = 0.0;
+	/// Relative MIP gap, -1 if there is no solution.
+	double gap = -1.0;
+	/// Seconds until the first incumbent was found, -1 if none was.
+	double first_incumbent = -1.0;
+};
+
+/// Budgets of a single solve, non-positive values impose no limit.
+struct SolveLimits
+{
+	/// Wall-clock seconds.
+	double time = 0.0;
+	/// Relative MIP gap at which the solve stops.
+	double gap = 0.0;
+};
+
 class ILPProblem
 {
   public:
 	using Result =
 	    std::pair<std::vector<std::string>, std::vector<std::string>>;
+	/// Receives the objective and bound of every improved incumbent,
+	/// together with the seconds since the solve started.
+	using IncumbentCallback =
+	    std::function<void(double objective, double bound, double seconds)>;
+	/// Refers to finalized mappings without copying them, such that
+	/// problems on the same mappings share them. These then need to
+	/// outlive the problem. Mappings that are not finalized are copied.
 	explicit ILPProblem(const TargetMappings& mappings);
+	/// Takes over the mappings and finalizes them.
 	explicit ILPProblem(TargetMappings&& mappings);
 
-	~ILPProblem();
+	virtual ~ILPProblem();
 
 	std::size_t numVariables() const;
 	std::size_t numConstraints() const;
 	std::size_t numNonZero() const;
 
+	void setNumThreads(int threads);
+	/// Number of CPLEX threads for each of jobs concurrently solved
+	/// problems, such that the available cores are split between them.
+	static int threadsPerJob(std::size_t jobs);
+	/// CPLEX aborts the running solve as soon as *flag becomes non-zero.
+	void setTerminationFlag(volatile int* flag);
+	/// Makes solve() return the best incumbent once a limit is reached.
+	void setLimits(const SolveLimits& limits);
+	/// Called from CPLEX threads whenever the incumbent improves.
+	void setIncumbentCallback(IncumbentCallback callback);
+
+	/// Returns the best solution found, which is optimal unless a limit
+	/// was hit or the solve was terminated, see solveStats(). Throws a
+	/// CPLEXException if no solution was found.
 	virtual Result solve();
 
+	/**
+	 * Solves only the LP relaxation and rounds its solution to a feasible
+	 * one, keeping the best of the given number of randomized roundings.
+	 * objectiveValue() then refers to the rounded solution and lpBound()
+	 * to the relaxation, which bounds the optimum.
+	 */
+	Result solveApproximately(std::size_t rounds = 16,
+	                          std::uint64_t seed = 1);
+	/// Objective of the LP relaxation solved by solveApproximately().
+	double lpBound() const;
+
+	/// Objective value of the solution found by the last call to solve().
+	double objectiveValue() const;
+	/// miRNA indices selected by the solution of the last call to solve().
+	const std::vector<std::size_t>& selectedMirnas() const;
+
+	/// The reduced instance the ILP formulation is built from.
+	const InstanceReduction& reducedInstance() const;
+
+	/// Time spent in the phases of building the formulation.
+	const std::vector<PhaseTime>& buildTimes() const;
+	/// Statistics of the last call to solve().
+	const SolveStats& solveStats() const;
+
   protected:
-	TargetMappings mappings_;
+	// Set if the problem could not refer to the mappings passed in
+	std::unique_ptr<const TargetMappings> owned_mappings_;
+	const TargetMappings& mappings_;
+	// Borrowed from the global pool for the lifetime of the problem
+	CPLEXEnvironmentPool::Lease environment_;
 	CPXENVptr env_;
 	CPXLPptr lp_;
 
+	std::unique_ptr<InstanceReduction> instance_;
+	std::unique_ptr<GreedyCover> greedy_;
+
+	double objective_;
+	double lp_bound_;
+	std::vector<std::size_t> selected_mirnas_;
+	std::vector<PhaseTime> build_times_;
+
+	SolveStats solve_stats_;
+	Stopwatch solve_watch_;
+	std::atomic<double> first_incumbent_;
+	IncumbentCallback incumbent_callback_;
+	std::mutex incumbent_mutex_;
+	bool first_report_;
+	double last_incumbent_;
+	double known_bound_;
+
 	virtual void createProblem_();
 	virtual void createObjectiveFunction_() = 0;
 	virtual void createConstraints_() = 0;
 
 	virtual bool checkSolution_(const std::vector<double>& row) const;
 
+	/// Rounds a fractional solution of the reduced miRNA variables to a
+	/// feasible selection of the reduced instance.
+	virtual std::vector<std::size_t>
+	round_(const std::vector<double>& x, std::mt19937_64& rng) const = 0;
+	/// Objective value of a selection of the reduced instance.
+	virtual double
+	evaluate_(const std::vector<std::size_t>& selection) const = 0;
+
+	/// Selects every miRNA floor(x) times plus once more with probability
+	/// equal to the fractional part.
+	std::vector<std::size_t> roundIndependently_(const std::vector<double>& x,
+	                                             std::mt19937_64& rng) const;
+	/// Like roundIndependently_(), but the fractional parts are rounded
+	/// pairwise such that the selection size equals the rounded sum of x.
+	std::vector<std::size_t> roundDependently_(const std::vector<double>& x,
+	                                           std::mt19937_64& rng) const;
+
+	void createColumns_(const std::vector<double>& objective);
 	void createMappingConstraints_();
+	void clearMipStarts_();
+	void addMipStart_(const std::vector<std::size_t>& mirnas);
+	void setLowerCutoff_(double cutoff);
+	/// Upper bound on the optimum of a maximization problem known in
+	/// advance, solves stop as soon as their incumbent reaches it.
+	void setKnownBound_(double bound);
 	void handleCPLEXError_(int status);
+
+  private:
+	void recordSolveStats_();
+	Result makeResult_(const std::vector<std::size_t>& reduced);
+	static int CPXPUBLIC incumbentCallback_(CPXCENVptr env, void* cbdata,
+	                                        int wherefrom, void* handle);
 };
 
 #endif // ILPPROBLEM_H
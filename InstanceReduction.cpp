@@ -0,0 +1,211 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "InstanceReduction.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+using Lists = std::vector<std::vector<std::size_t>>;
+
+// Groups equal lists. Returns the group of every list and the number of
+// groups, groups are numbered by their first occurrence.
+std::size_t groupIdentical(const Lists& lists, std::vector<std::size_t>& group)
+{
+	std::vector<std::size_t> order(lists.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(),
+	                 [&lists](std::size_t a, std::size_t b) {
+		                 return lists[a] < lists[b];
+		             });
+
+	// Representative (smallest index) of every run of equal lists
+	std::vector<std::size_t> rep(lists.size());
+	for(size_t i = 0; i < order.size(); ++i) {
+		if(i > 0 && lists[order[i]] == lists[order[i - 1]]) {
+			rep[order[i]] = rep[order[i - 1]];
+		} else {
+			rep[order[i]] = order[i];
+		}
+	}
+
+	const std::size_t none = lists.size();
+	std::vector<std::size_t> rep_group(lists.size(), none);
+	std::size_t num_groups = 0;
+
+	group.resize(lists.size());
+	for(size_t i = 0; i < lists.size(); ++i) {
+		if(rep_group[rep[i]] == none) {
+			rep_group[rep[i]] = num_groups++;
+		}
+		group[i] = rep_group[rep[i]];
+	}
+
+	return num_groups;
+}
+}
+
+InstanceReduction::InstanceReduction(const TargetMappings& mappings)
+{
+	const std::size_t num_mirnas = mappings.numMirnas();
+	const std::size_t num_genes = mappings.numGenes();
+
+	const auto& offsets = mappings.mirnaOffsets();
+	const auto& genes = mappings.mirnaGenes();
+	Lists targets(num_mirnas);
+	for(size_t m = 0; m < num_mirnas; ++m) {
+		targets[m].assign(genes.begin() + offsets[m],
+		                  genes.begin() + offsets[m + 1]);
+	}
+
+	std::vector<std::size_t> mirna_group;
+	const std::size_t num_groups = groupIdentical(targets, mirna_group);
+
+	Lists group_targets(num_groups);
+	Lists group_members(num_groups);
+	for(size_t m = 0; m < num_mirnas; ++m) {
+		if(group_members[mirna_group[m]].empty()) {
+			group_targets[mirna_group[m]] = std::move(targets[m]);
+		}
+		group_members[mirna_group[m]].push_back(m);
+	}
+
+	Lists regulators(num_genes);
+	for(size_t c = 0; c < num_groups; ++c) {
+		for(std::size_t g : group_targets[c]) {
+			regulators[g].push_back(c);
+		}
+	}
+
+	// A group is dominated if another group's targets are a strict
+	// superset. Such a group regulates all genes of the dominated one, so
+	// it suffices to check the regulators of its least regulated target.
+	std::vector<bool> dominated(num_groups, false);
+	for(size_t c = 0; c < num_groups; ++c) {
+		const auto& t = group_targets[c];
+		if(t.empty()) {
+			// Any other group has targets
+			dominated[c] = num_groups > 1;
+			continue;
+		}
+
+		const auto least = std::min_element(
+		    t.begin(), t.end(), [&regulators](std::size_t a, std::size_t b) {
+			    return regulators[a].size() < regulators[b].size();
+			});
+
+		for(std::size_t d : regulators[*least]) {
+			const auto& u = group_targets[d];
+			if(u.size() > t.size() &&
+			   std::includes(u.begin(), u.end(), t.begin(), t.end())) {
+				dominated[c] = true;
+				break;
+			}
+		}
+	}
+
+	// Renumber the kept groups, the filler class comes last
+	const std::size_t none = num_groups;
+	std::vector<std::size_t> new_index(num_groups, none);
+	std::vector<std::size_t> fillers;
+	for(size_t c = 0; c < num_groups; ++c) {
+		if(dominated[c]) {
+			fillers.insert(fillers.end(), group_members[c].begin(),
+			               group_members[c].end());
+		} else {
+			new_index[c] = members_.size();
+			members_.push_back(std::move(group_members[c]));
+		}
+	}
+
+	if(!fillers.empty()) {
+		std::sort(fillers.begin(), fillers.end());
+		members_.push_back(std::move(fillers));
+	}
+
+	mirna_class_.resize(num_mirnas);
+	for(size_t i = 0; i < members_.size(); ++i) {
+		for(std::size_t m : members_[i]) {
+			mirna_class_[m] = i;
+		}
+	}
+
+	// Regulator sets of the genes in terms of the kept classes
+	for(auto& regs : regulators) {
+		auto it = std::remove_if(regs.begin(), regs.end(),
+		                         [&dominated](std::size_t c) {
+			                         return dominated[c];
+			                     });
+		regs.erase(it, regs.end());
+		for(auto& c : regs) {
+			c = new_index[c];
+		}
+	}
+
+	std::vector<std::size_t> gene_group;
+	const std::size_t num_gene_groups = groupIdentical(regulators, gene_group);
+
+	gene_weights_.assign(num_gene_groups, 0);
+	std::vector<std::size_t> gene_rep(num_gene_groups, num_genes);
+	for(size_t g = 0; g < num_genes; ++g) {
+		if(gene_weights_[gene_group[g]]++ == 0) {
+			gene_rep[gene_group[g]] = g;
+		}
+	}
+
+	// Renumbering preserves the order of the kept classes, thus the
+	// regulator lists are still sorted.
+	gene_offsets_.assign(1, 0);
+	for(size_t g = 0; g < num_gene_groups; ++g) {
+		const auto& regs = regulators[gene_rep[g]];
+		gene_mirnas_.insert(gene_mirnas_.end(), regs.begin(), regs.end());
+		gene_offsets_.push_back(gene_mirnas_.size());
+	}
+}
+
+std::vector<std::size_t>
+InstanceReduction::reduceMirnas(const std::vector<std::size_t>& mirnas) const
+{
+	std::vector<std::size_t> result;
+	result.reserve(mirnas.size());
+
+	for(std::size_t m : mirnas) {
+		result.push_back(mirna_class_[m]);
+	}
+
+	return result;
+}
+
+std::vector<std::size_t>
+InstanceReduction::expandMirnas(const std::vector<std::size_t>& mirnas) const
+{
+	std::vector<std::size_t> used(members_.size(), 0);
+	std::vector<std::size_t> result;
+	result.reserve(mirnas.size());
+
+	for(std::size_t c : mirnas) {
+		if(used[c] < members_[c].size()) {
+			result.push_back(members_[c][used[c]++]);
+		}
+	}
+
+	std::sort(result.begin(), result.end());
+
+	return result;
+}
@@ -0,0 +1,99 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MINMAX_INSTANCEREDUCTION_H
+#define MINMAX_INSTANCEREDUCTION_H
+
+#include "TargetMappings.h"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Shrinks a finalized set of mappings before building an ILP:
+ *
+ * - miRNAs with identical target sets are merged into one class whose
+ *   variable may be selected up to the size of the class.
+ * - miRNAs whose targets are a strict subset of another miRNA's targets
+ *   are dominated. Replacing them by their dominator never decreases the
+ *   coverage, so they only serve as fillers for the cardinality
+ *   constraint. They are moved into a single filler class without targets.
+ * - Genes with identical (remaining) regulator sets are merged into one
+ *   gene whose weight is the number of merged genes.
+ *
+ * The reduced mappings are stored as gene-major CSR adjacency, like
+ * finalized TargetMappings.
+ */
+class InstanceReduction
+{
+  public:
+	using const_iterator = MappingIterator;
+
+	explicit InstanceReduction(const TargetMappings& mappings);
+
+	const_iterator begin() const
+	{
+		return MappingIterator(gene_offsets_.data(), gene_mirnas_.data(),
+		                       numGenes(), 0);
+	}
+
+	const_iterator end() const
+	{
+		return MappingIterator(gene_offsets_.data(), gene_mirnas_.data(), 0,
+		                       gene_mirnas_.size());
+	}
+
+	std::size_t numGenes() const { return gene_weights_.size(); }
+	std::size_t numMirnas() const { return members_.size(); }
+	std::size_t numMappings() const { return gene_mirnas_.size(); }
+
+	/// The regulators of reduced gene g are
+	/// geneMirnas()[geneOffsets()[g] ... geneOffsets()[g + 1]].
+	const std::vector<std::uint64_t>& geneOffsets() const
+	{
+		return gene_offsets_;
+	}
+	const std::vector<std::uint32_t>& geneMirnas() const
+	{
+		return gene_mirnas_;
+	}
+
+	/// Number of original genes represented by reduced gene i.
+	std::size_t geneWeight(std::size_t i) const { return gene_weights_[i]; }
+	/// Number of original miRNAs represented by reduced miRNA i.
+	std::size_t mirnaMultiplicity(std::size_t i) const
+	{
+		return members_[i].size();
+	}
+
+	/// Maps original miRNA indices to reduced ones, keeping duplicates.
+	std::vector<std::size_t>
+	reduceMirnas(const std::vector<std::size_t>& mirnas) const;
+	/// Maps reduced miRNA indices, possibly repeated up to their
+	/// multiplicity, back to distinct original miRNAs.
+	std::vector<std::size_t>
+	expandMirnas(const std::vector<std::size_t>& mirnas) const;
+
+  private:
+	std::vector<std::uint64_t> gene_offsets_;
+	std::vector<std::uint32_t> gene_mirnas_;
+	std::vector<std::size_t> gene_weights_;
+	std::vector<std::size_t> mirna_class_;
+	std::vector<std::vector<std::size_t>> members_;
+};
+
+#endif // MINMAX_INSTANCEREDUCTION_H
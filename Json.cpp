@@ -0,0 +1,303 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Json.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+class JsonParser
+{
+  public:
+	explicit JsonParser(std::string_view text) : text_(text), pos_(0) {}
+
+	JsonValue parseDocument()
+	{
+		JsonValue result = parseValue_(0);
+		skipSpace_();
+		if(pos_ != text_.size()) {
+			fail_("trailing characters");
+		}
+
+		return result;
+	}
+
+  private:
+	// Requests are flat, deeper nesting only serves to exhaust the stack
+	static const std::size_t MAX_DEPTH = 64;
+
+	std::string_view text_;
+	std::size_t pos_;
+
+	[[noreturn]] void fail_(const char* what) const
+	{
+		throw std::runtime_error(std::string("Invalid JSON: ") + what +
+		                         " at offset " + std::to_string(pos_));
+	}
+
+	void skipSpace_()
+	{
+		while(pos_ < text_.size() &&
+		      (text_[pos_] == ' ' || text_[pos_] == '\t' ||
+		       text_[pos_] == '\n' || text_[pos_] == '\r')) {
+			++pos_;
+		}
+	}
+
+	bool consume_(char c)
+	{
+		skipSpace_();
+		if(pos_ < text_.size() && text_[pos_] == c) {
+			++pos_;
+			return true;
+		}
+
+		return false;
+	}
+
+	void expect_(char c)
+	{
+		if(!consume_(c)) {
+			fail_("unexpected character");
+		}
+	}
+
+	bool literal_(std::string_view word)
+	{
+		if(text_.substr(pos_, word.size()) == word) {
+			pos_ += word.size();
+			return true;
+		}
+
+		return false;
+	}
+
+	JsonValue parseValue_(std::size_t depth)
+	{
+		if(depth > MAX_DEPTH) {
+			fail_("nesting too deep");
+		}
+
+		skipSpace_();
+		if(pos_ >= text_.size()) {
+			fail_("unexpected end");
+		}
+
+		JsonValue v;
+		const char c = text_[pos_];
+		if(c == '{') {
+			v.type_ = JsonValue::Type::Object;
+			++pos_;
+			if(!consume_('}')) {
+				do {
+					skipSpace_();
+					std::string key = parseString_();
+					expect_(':');
+					JsonValue value = parseValue_(depth + 1);
+					v.object_.emplace_back(std::move(key), std::move(value));
+				} while(consume_(','));
+				expect_('}');
+			}
+		} else if(c == '[') {
+			v.type_ = JsonValue::Type::Array;
+			++pos_;
+			if(!consume_(']')) {
+				do {
+					v.array_.push_back(parseValue_(depth + 1));
+				} while(consume_(','));
+				expect_(']');
+			}
+		} else if(c == '"') {
+			v.type_ = JsonValue::Type::String;
+			v.string_ = parseString_();
+		} else if(literal_("true")) {
+			v.type_ = JsonValue::Type::Bool;
+			v.bool_ = true;
+		} else if(literal_("false")) {
+			v.type_ = JsonValue::Type::Bool;
+		} else if(literal_("null")) {
+			v.type_ = JsonValue::Type::Null;
+		} else {
+			v.type_ = JsonValue::Type::Number;
+			v.number_ = parseNumber_();
+		}
+
+		return v;
+	}
+
+	double parseNumber_()
+	{
+		const std::size_t begin = pos_;
+		while(pos_ < text_.size() &&
+		      std::string_view("+-0123456789.eE").find(text_[pos_]) !=
+		          std::string_view::npos) {
+			++pos_;
+		}
+
+		const std::string number(text_.substr(begin, pos_ - begin));
+		char* end = nullptr;
+		const double result = std::strtod(number.c_str(), &end);
+		if(number.empty() || end != number.c_str() + number.size()) {
+			fail_("invalid number");
+		}
+
+		return result;
+	}
+
+	std::string parseString_()
+	{
+		if(pos_ >= text_.size() || text_[pos_] != '"') {
+			fail_("expected string");
+		}
+
+		std::string result;
+		for(++pos_; pos_ < text_.size() && text_[pos_] != '"'; ++pos_) {
+			if(text_[pos_] != '\\') {
+				result += text_[pos_];
+				continue;
+			}
+
+			if(++pos_ >= text_.size()) {
+				break;
+			}
+
+			// Escaped control characters and their replacements
+			const std::string_view escapes = "bfnrt";
+			const std::string_view controls = "\b\f\n\r\t";
+			const std::size_t i = escapes.find(text_[pos_]);
+			if(text_[pos_] == 'u') {
+				appendCodePoint_(result);
+			} else if(i != std::string_view::npos) {
+				result += controls[i];
+			} else {
+				result += text_[pos_];
+			}
+		}
+
+		if(pos_ >= text_.size()) {
+			fail_("unterminated string");
+		}
+
+		++pos_;
+		return result;
+	}
+
+	void appendCodePoint_(std::string& out)
+	{
+		if(pos_ + 4 >= text_.size()) {
+			fail_("invalid escape");
+		}
+
+		const std::string hex(text_.substr(pos_ + 1, 4));
+		char* end = nullptr;
+		const unsigned long cp = std::strtoul(hex.c_str(), &end, 16);
+		if(end != hex.c_str() + 4) {
+			fail_("invalid escape");
+		}
+		pos_ += 4;
+
+		// Surrogate pairs are not combined, names are expected to be ASCII
+		if(cp < 0x80) {
+			out += static_cast<char>(cp);
+		} else if(cp < 0x800) {
+			out += static_cast<char>(0xC0 | (cp >> 6));
+			out += static_cast<char>(0x80 | (cp & 0x3F));
+		} else {
+			out += static_cast<char>(0xE0 | (cp >> 12));
+			out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+			out += static_cast<char>(0x80 | (cp & 0x3F));
+		}
+	}
+};
+
+JsonValue JsonValue::parse(std::string_view text)
+{
+	return JsonParser(text).parseDocument();
+}
+
+namespace
+{
+[[noreturn]] void typeError(const char* expected)
+{
+	throw std::runtime_error(std::string("Expected a JSON ") + expected + ".");
+}
+}
+
+bool JsonValue::asBool() const
+{
+	if(type_ != Type::Bool) {
+		typeError("boolean");
+	}
+
+	return bool_;
+}
+
+double JsonValue::asNumber() const
+{
+	if(type_ != Type::Number) {
+		typeError("number");
+	}
+
+	return number_;
+}
+
+const std::string& JsonValue::asString() const
+{
+	if(type_ != Type::String) {
+		typeError("string");
+	}
+
+	return string_;
+}
+
+const std::vector<JsonValue>& JsonValue::asArray() const
+{
+	if(type_ != Type::Array) {
+		typeError("array");
+	}
+
+	return array_;
+}
+
+const JsonValue* JsonValue::find(std::string_view key) const
+{
+	for(const auto& member : object_) {
+		if(member.first == key) {
+			return &member.second;
+		}
+	}
+
+	return nullptr;
+}
+
+void writeJsonString(std::ostream& out, std::string_view s)
+{
+	out << '"';
+	for(char c : s) {
+		if(c == '"' || c == '\\') {
+			out << '\\' << c;
+		} else if(static_cast<unsigned char>(c) < 0x20) {
+			char buffer[8];
+			std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+			out << buffer;
+		} else {
+			out << c;
+		}
+	}
+	out << '"';
+}
@@ -0,0 +1,68 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MINMAX_JSON_H
+#define MINMAX_JSON_H
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * Minimal JSON document model for the line based request protocols.
+ * Numbers are stored as double.
+ */
+class JsonValue
+{
+  public:
+	enum class Type { Null, Bool, Number, String, Array, Object };
+
+	JsonValue() : type_(Type::Null) {}
+
+	/// Parses a complete JSON document. Throws std::runtime_error on
+	/// malformed input.
+	static JsonValue parse(std::string_view text);
+
+	Type type() const { return type_; }
+	bool isNull() const { return type_ == Type::Null; }
+
+	/// Accessors throw std::runtime_error if the value has another type.
+	bool asBool() const;
+	double asNumber() const;
+	const std::string& asString() const;
+	const std::vector<JsonValue>& asArray() const;
+
+	/// Member of an object or nullptr if it does not exist.
+	const JsonValue* find(std::string_view key) const;
+
+  private:
+	Type type_;
+	bool bool_ = false;
+	double number_ = 0.0;
+	std::string string_;
+	std::vector<JsonValue> array_;
+	std::vector<std::pair<std::string, JsonValue>> object_;
+
+	friend class JsonParser;
+};
+
+/// Writes s as a quoted and escaped JSON string.
+void writeJsonString(std::ostream& out, std::string_view s);
+
+#endif // MINMAX_JSON_H
@@ -0,0 +1,202 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "LagrangianBound.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+LagrangianBound::LagrangianBound(const InstanceReduction& instance)
+    : gene_weights_(instance.numGenes()),
+      multiplicities_(instance.numMirnas()),
+      offsets_(instance.numMirnas() + 1, 0),
+      max_iterations_(500),
+      iterations_(0),
+      lower_bound_(0.0)
+{
+	for(size_t i = 0; i < gene_weights_.size(); ++i) {
+		gene_weights_[i] = instance.geneWeight(i);
+	}
+
+	for(size_t i = 0; i < multiplicities_.size(); ++i) {
+		multiplicities_[i] = instance.mirnaMultiplicity(i);
+	}
+
+	// Build miRNA -> gene adjacency lists in CSR format
+	for(const auto& mapping : instance) {
+		++offsets_[mapping.mirna() + 1];
+	}
+
+	for(size_t i = 1; i < offsets_.size(); ++i) {
+		offsets_[i] += offsets_[i - 1];
+	}
+
+	targets_.resize(offsets_.back());
+	std::vector<std::size_t> pos(offsets_.begin(), offsets_.end() - 1);
+	for(const auto& mapping : instance) {
+		targets_[pos[mapping.mirna()]++] = mapping.gene();
+	}
+}
+
+void LagrangianBound::setMaxIterations(std::size_t iterations)
+{
+	max_iterations_ = iterations;
+}
+
+const std::vector<std::size_t>& LagrangianBound::selection() const
+{
+	return selection_;
+}
+
+double LagrangianBound::lowerBound() const { return lower_bound_; }
+
+std::size_t LagrangianBound::iterations() const { return iterations_; }
+
+double LagrangianBound::evaluate_(const std::vector<double>& multipliers,
+                                  std::size_t k,
+                                  std::vector<std::size_t>& selection) const
+{
+	const std::size_t num_mirnas = multiplicities_.size();
+	std::vector<double> scores(num_mirnas, 0.0);
+	for(size_t m = 0; m < num_mirnas; ++m) {
+		for(size_t i = offsets_[m]; i < offsets_[m + 1]; ++i) {
+			scores[m] += multipliers[targets_[i]];
+		}
+	}
+
+	// Every miRNA has at least one copy, the k best ones suffice
+	std::vector<std::size_t> order(num_mirnas);
+	std::iota(order.begin(), order.end(), 0);
+	const auto last = order.begin() + std::min(k, num_mirnas);
+	auto higher = [&scores](std::size_t a, std::size_t b) {
+		return scores[a] > scores[b];
+	};
+	std::partial_sort(order.begin(), last, order.end(), higher);
+	order.erase(last, order.end());
+
+	double value = 0.0;
+	selection.clear();
+	for(size_t i = 0; i < order.size() && selection.size() < k; ++i) {
+		const std::size_t m = order[i];
+		const std::size_t count =
+		    std::min(multiplicities_[m], k - selection.size());
+		selection.insert(selection.end(), count, m);
+		value += count * scores[m];
+	}
+
+	for(size_t g = 0; g < gene_weights_.size(); ++g) {
+		value += std::max(0.0, gene_weights_[g] - multipliers[g]);
+	}
+
+	return value;
+}
+
+double
+LagrangianBound::coveredWeight_(const std::vector<std::size_t>& selection) const
+{
+	std::vector<bool> covered(gene_weights_.size(), false);
+	double result = 0.0;
+	for(std::size_t m : selection) {
+		for(size_t i = offsets_[m]; i < offsets_[m + 1]; ++i) {
+			if(!covered[targets_[i]]) {
+				covered[targets_[i]] = true;
+				result += gene_weights_[targets_[i]];
+			}
+		}
+	}
+
+	return result;
+}
+
+double LagrangianBound::maxCoverage(std::size_t k, double lower_bound)
+{
+	const std::size_t num_genes = gene_weights_.size();
+	const double eps = 1e-6;
+
+	lower_bound_ = lower_bound;
+	selection_.clear();
+	iterations_ = 0;
+
+	// Half of the weight of a gene is a neutral guess for the price of
+	// covering it.
+	std::vector<double> multipliers(num_genes);
+	for(size_t g = 0; g < num_genes; ++g) {
+		multipliers[g] = 0.5 * gene_weights_[g];
+	}
+
+	double best = std::numeric_limits<double>::infinity();
+	double step = 2.0;
+	std::size_t since_improvement = 0;
+
+	std::vector<std::size_t> selection;
+	std::vector<double> subgradient(num_genes);
+
+	while(iterations_ < max_iterations_ && step > 1e-4) {
+		++iterations_;
+
+		const double value = evaluate_(multipliers, k, selection);
+		if(value < best - eps) {
+			best = value;
+			since_improvement = 0;
+		} else if(++since_improvement >= 20) {
+			step *= 0.5;
+			since_improvement = 0;
+		}
+
+		const double covered = coveredWeight_(selection);
+		if(covered > lower_bound_ || selection_.empty()) {
+			lower_bound_ = std::max(lower_bound_, covered);
+			selection_ = selection;
+		}
+
+		// Objectives are integral, the bound can be rounded down
+		if(std::floor(best + eps) <= lower_bound_ + eps) {
+			break;
+		}
+
+		// Violation of the relaxed rows: copies covering g minus y_g
+		for(size_t g = 0; g < num_genes; ++g) {
+			subgradient[g] =
+			    gene_weights_[g] > multipliers[g] ? -1.0 : 0.0;
+		}
+
+		for(std::size_t m : selection) {
+			for(size_t i = offsets_[m]; i < offsets_[m + 1]; ++i) {
+				subgradient[targets_[i]] += 1.0;
+			}
+		}
+
+		double norm = 0.0;
+		for(double s : subgradient) {
+			norm += s * s;
+		}
+
+		if(norm == 0.0) {
+			break;
+		}
+
+		// Polyak step towards the best known solution
+		const double t = step * (value - lower_bound_) / norm;
+		for(size_t g = 0; g < num_genes; ++g) {
+			multipliers[g] = std::max(0.0, multipliers[g] - t * subgradient[g]);
+		}
+	}
+
+	return std::floor(best + eps);
+}
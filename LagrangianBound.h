@@ -0,0 +1,73 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MINMAX_LAGRANGIANBOUND_H
+#define MINMAX_LAGRANGIANBOUND_H
+
+#include "InstanceReduction.h"
+
+#include <vector>
+
+/**
+ * Upper bounds for maximum coverage by Lagrangian relaxation of the
+ * coverage rows y_g <= sum of the regulators of g. For fixed multipliers
+ * the relaxation decomposes: a gene is taken if its weight exceeds its
+ * multiplier, and the k miRNA copies with the largest sums of target
+ * multipliers are selected. The multipliers are improved by subgradient
+ * steps.
+ *
+ * The miRNAs selected by the relaxation form a feasible solution, the
+ * best of which is kept as a lower bound. Selections are given in terms
+ * of the reduced instance.
+ */
+class LagrangianBound
+{
+  public:
+	explicit LagrangianBound(const InstanceReduction& instance);
+
+	void setMaxIterations(std::size_t iterations);
+
+	/**
+	 * Upper bound on the weight coverable by k miRNAs. The objective of a
+	 * known solution speeds up convergence, the computation stops early
+	 * once the bound matches the best known solution.
+	 */
+	double maxCoverage(std::size_t k, double lower_bound = 0.0);
+
+	/// Best solution found by the last call to maxCoverage() and its
+	/// objective, which is at least the passed lower bound.
+	const std::vector<std::size_t>& selection() const;
+	double lowerBound() const;
+	std::size_t iterations() const;
+
+  private:
+	std::vector<double> gene_weights_;
+	std::vector<std::size_t> multiplicities_;
+	std::vector<std::size_t> offsets_;
+	std::vector<std::size_t> targets_;
+
+	std::size_t max_iterations_;
+	std::size_t iterations_;
+	std::vector<std::size_t> selection_;
+	double lower_bound_;
+
+	double evaluate_(const std::vector<double>& multipliers, std::size_t k,
+	                 std::vector<std::size_t>& selection) const;
+	double coveredWeight_(const std::vector<std::size_t>& selection) const;
+};
+
+#endif // MINMAX_LAGRANGIANBOUND_H
@@ -0,0 +1,298 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "MappingsParser.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+struct Chunk
+{
+	// Names in order of their first appearance within the chunk
+	NameTable mirnas;
+	NameTable genes;
+	std::vector<std::pair<std::uint32_t, std::uint32_t>> mappings;
+};
+
+bool isBlank(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+std::string_view nextToken(const char*& p, const char* end)
+{
+	while(p < end && isBlank(*p)) {
+		++p;
+	}
+
+	const char* begin = p;
+	while(p < end && !isBlank(*p)) {
+		++p;
+	}
+
+	return std::string_view(begin, p - begin);
+}
+
+// Expects the thresholds of the filter to be sorted by column
+bool accepts(const MappingsFilter& filter, std::string_view gene,
+             const char* p, const char* eol)
+{
+	if(filter.restrict_genes && filter.genes.find(gene) == NameTable::npos) {
+		return false;
+	}
+
+	std::size_t column = 2;
+	std::string_view field;
+	for(const auto& threshold : filter.thresholds) {
+		for(; column < threshold.column; ++column) {
+			field = nextToken(p, eol);
+		}
+
+		const char* end = field.data() + field.size();
+		double value = 0.0;
+		const auto result = std::from_chars(field.data(), end, value);
+		if(field.empty() || result.ec != std::errc() || result.ptr != end ||
+		   value < threshold.min_score) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void parseChunk(const char* p, const char* end, Chunk& chunk,
+                const MappingsFilter& filter)
+{
+	while(p < end) {
+		const char* eol =
+		    static_cast<const char*>(std::memchr(p, '\n', end - p));
+		if(!eol) {
+			eol = end;
+		}
+
+		// Lines with less than two fields are skipped, additional fields
+		// are ignored.
+		const std::string_view mirna = nextToken(p, eol);
+		const std::string_view gene = nextToken(p, eol);
+		if(!gene.empty() && (filter.empty() || accepts(filter, gene, p, eol))) {
+			chunk.mappings.emplace_back(chunk.mirnas.insert(mirna),
+			                            chunk.genes.insert(gene));
+		}
+
+		p = eol + 1;
+	}
+}
+
+// Translates chunk local ids into global ones
+template <typename AddFunc>
+std::vector<std::uint32_t> mergeNames(const NameTable& names, AddFunc add)
+{
+	std::vector<std::uint32_t> result(names.size());
+	for(size_t i = 0; i < names.size(); ++i) {
+		result[i] = add(names[i]);
+	}
+
+	return result;
+}
+
+void addChunks(const std::vector<Chunk>& chunks, TargetMappings& mappings)
+{
+	auto add_mirna = [&](std::string_view n) { return mappings.addMirna(n); };
+	auto add_gene = [&](std::string_view n) { return mappings.addGene(n); };
+
+	std::size_t num_mappings = 0;
+	std::vector<std::vector<std::uint32_t>> mirna_map(chunks.size());
+	std::vector<std::vector<std::uint32_t>> gene_map(chunks.size());
+	for(size_t i = 0; i < chunks.size(); ++i) {
+		mirna_map[i] = mergeNames(chunks[i].mirnas, add_mirna);
+		gene_map[i] = mergeNames(chunks[i].genes, add_gene);
+		num_mappings += chunks[i].mappings.size();
+	}
+
+	// Exact reservations for every block of a stream would copy the
+	// mappings over and over, later blocks rely on geometric growth.
+	if(mappings.numMappings() == 0) {
+		mappings.reserve(num_mappings);
+	}
+
+	for(size_t i = 0; i < chunks.size(); ++i) {
+		for(const auto& m : chunks[i].mappings) {
+			mappings.add(mirna_map[i][m.first], gene_map[i][m.second]);
+		}
+	}
+}
+
+// Parses the complete lines between begin and end on up to the given
+// number of threads and adds them to the mappings.
+void parseLines(const char* begin, const char* end, std::size_t threads,
+                const MappingsFilter& filter, TargetMappings& mappings)
+{
+	const std::size_t size = end - begin;
+
+	// Split at line boundaries, small inputs are parsed by a single thread
+	const std::size_t min_chunk = 1 << 20;
+	threads = std::max<std::size_t>(
+	    1, std::min(threads, (size + min_chunk - 1) / min_chunk));
+
+	std::vector<const char*> bounds(1, begin);
+	for(size_t i = 1; i < threads; ++i) {
+		const char* p = std::max(bounds.back(), begin + i * (size / threads));
+		p = static_cast<const char*>(std::memchr(p, '\n', end - p));
+		bounds.push_back(p ? p + 1 : end);
+	}
+	bounds.push_back(end);
+
+	std::vector<Chunk> chunks(threads);
+	std::vector<std::thread> workers;
+	for(size_t i = 1; i < threads; ++i) {
+		workers.emplace_back(parseChunk, bounds[i], bounds[i + 1],
+		                     std::ref(chunks[i]), std::cref(filter));
+	}
+
+	parseChunk(bounds[0], bounds[1], chunks[0], filter);
+
+	for(auto& w : workers) {
+		w.join();
+	}
+
+	addChunks(chunks, mappings);
+}
+
+bool isGzip(const std::string& path)
+{
+	FILE* file = std::fopen(path.c_str(), "rb");
+	if(!file) {
+		return false;
+	}
+
+	unsigned char magic[2] = {0, 0};
+	const bool gzip = std::fread(magic, 1, 2, file) == 2 &&
+	                  magic[0] == 0x1f && magic[1] == 0x8b;
+	std::fclose(file);
+
+	return gzip;
+}
+
+bool parseGzipMappings(const std::string& path, TargetMappings& mappings,
+                       std::size_t threads, const MappingsFilter& filter)
+{
+	gzFile file = gzopen(path.c_str(), "rb");
+	if(!file) {
+		return false;
+	}
+
+	// Complete lines of every block are parsed and added right away, the
+	// incomplete last line is moved to the front of the next block.
+	const std::size_t block = 1 << 22;
+	std::vector<char> buffer;
+	std::size_t pending = 0;
+
+	while(true) {
+		buffer.resize(pending + block);
+		const int read = gzread(file, buffer.data() + pending, block);
+		if(read < 0) {
+			gzclose(file);
+			return false;
+		}
+
+		const char* begin = buffer.data();
+		const char* end = begin + pending + read;
+		if(read == 0) {
+			parseLines(begin, end, threads, filter, mappings);
+			break;
+		}
+
+		const char* eol = end;
+		while(eol > begin && eol[-1] != '\n') {
+			--eol;
+		}
+
+		parseLines(begin, eol, threads, filter, mappings);
+		pending = end - eol;
+		std::memmove(buffer.data(), eol, pending);
+	}
+
+	gzclose(file);
+
+	return true;
+}
+}
+
+bool parseMappings(const std::string& path, TargetMappings& mappings,
+                   std::size_t threads, const MappingsFilter& filter)
+{
+	MappingsFilter sorted = filter;
+	auto byColumn = [](const MappingsFilter::Threshold& a,
+	                   const MappingsFilter::Threshold& b) {
+		return a.column < b.column;
+	};
+	std::sort(sorted.thresholds.begin(), sorted.thresholds.end(), byColumn);
+
+	if(isGzip(path)) {
+		return parseGzipMappings(path, mappings, threads, sorted);
+	}
+
+	const int fd = open(path.c_str(), O_RDONLY);
+	if(fd < 0) {
+		return false;
+	}
+
+	struct stat info;
+	if(fstat(fd, &info) != 0) {
+		close(fd);
+		return false;
+	}
+
+	const std::size_t size = info.st_size;
+	if(size == 0) {
+		close(fd);
+		return true;
+	}
+
+	void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if(data == MAP_FAILED) {
+		return false;
+	}
+
+	madvise(data, size, MADV_SEQUENTIAL);
+
+	const char* begin = static_cast<const char*>(data);
+	const char* end = begin + size;
+
+	parseLines(begin, end, threads, sorted, mappings);
+
+	munmap(data, size);
+
+	return true;
+}
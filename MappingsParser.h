@@ -0,0 +1,65 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MINMAX_MAPPINGSPARSER_H
+#define MINMAX_MAPPINGSPARSER_H
+
+#include "NameTable.h"
+#include "TargetMappings.h"
+
+#include <string>
+#include <vector>
+
+/// Selects the lines of a mapping file to keep while parsing.
+struct MappingsFilter
+{
+	/// Minimal value of a numeric column, numbered from 1 such that the
+	/// miRNA and the gene are in columns 1 and 2.
+	struct Threshold
+	{
+		std::size_t column;
+		double min_score;
+	};
+
+	/// Only mappings of these genes are kept if restrict_genes is set.
+	bool restrict_genes = false;
+	NameTable genes;
+	/// Lines lacking a column or holding a non-numeric value are dropped.
+	std::vector<Threshold> thresholds;
+
+	bool empty() const { return !restrict_genes && thresholds.empty(); }
+};
+
+/**
+ * Reads a tab-delimited miRNA - gene mapping file. The file is memory
+ * mapped and split into chunks at line boundaries, which are tokenized in
+ * parallel without copying. The per-chunk name tables are merged in chunk
+ * order, so names receive the same ids as with sequential parsing.
+ *
+ * Gzip compressed files are decompressed on the fly by a single thread.
+ * The lines of every block are tokenized in parallel in the same way and
+ * added to the mappings before the next block is read. Lines rejected by
+ * the filter never reach the mappings, neither do names occurring only on
+ * such lines.
+ *
+ * Returns false if the file could not be opened or decompressed.
+ */
+bool parseMappings(const std::string& path, TargetMappings& mappings,
+                   std::size_t threads,
+                   const MappingsFilter& filter = MappingsFilter());
+
+#endif // MINMAX_MAPPINGSPARSER_H
@@ -0,0 +1,978 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "MaxGeneCurve.h"
+
+#include "CPLEXException.h"
+#include "GreedyCover.h"
+#include "LagrangianBound.h"
+#include "MaxGeneProblem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <thread>
+
+MaxGeneCurve::MaxGeneCurve(const TargetMappings& mappings)
+    : mappings_(mappings),
+      num_targets_(0),
+      jobs_(1),
+      max_mirnas_(mappings.numMirnas()),
+      threads_(0),
+      verbose_(true),
+      time_limit_(0.0),
+      terminate_(nullptr),
+      lagrangian_(false),
+      adaptive_(false),
+      bisect_(false),
+      cache_(nullptr),
+      complete_(true),
+      num_solved_(0)
+{
+	// Restricted mappings keep the ids of genes without targets
+	std::vector<bool> targeted(mappings.numGenes(), false);
+	for(const auto& mapping : mappings) {
+		targeted[mapping.gene()] = true;
+	}
+	num_targets_ = std::count(targeted.begin(), targeted.end(), true);
+}
+
+void MaxGeneCurve::setNumJobs(std::size_t jobs)
+{
+	jobs_ = std::max<std::size_t>(jobs, 1);
+}
+
+void MaxGeneCurve::setNumThreads(int threads) { threads_ = threads; }
+
+void MaxGeneCurve::setMaxMirnas(std::size_t k) { max_mirnas_ = k; }
+
+void MaxGeneCurve::setVerbose(bool verbose) { verbose_ = verbose; }
+
+void MaxGeneCurve::setSolveLimits(const SolveLimits& limits)
+{
+	limits_ = limits;
+}
+
+void MaxGeneCurve::setTimeLimit(double seconds) { time_limit_ = seconds; }
+
+void MaxGeneCurve::setTerminationFlag(volatile int* flag)
+{
+	terminate_ = flag;
+}
+
+void MaxGeneCurve::setLagrangianBound(bool enable) { lagrangian_ = enable; }
+
+void MaxGeneCurve::setAdaptive(bool adaptive, bool bisect)
+{
+	adaptive_ = adaptive;
+	bisect_ = bisect;
+}
+
+void MaxGeneCurve::setCache(const ResultCache* cache) { cache_ = cache; }
+
+bool MaxGeneCurve::complete() const { return complete_; }
+
+namespace
+{
+const char* const CURVE_KEY = "maxgene-curve";
+
+SolveStats cachedStats(const ResultCache::CurvePoint& point)
+{
+	SolveStats stats;
+	stats.k = point.k;
+	stats.status = "cached";
+	stats.optimal = true;
+	stats.objective = point.value;
+	stats.bound = point.value;
+	stats.gap = 0.0;
+	return stats;
+}
+}
+
+std::unique_ptr<MaxGeneProblem> MaxGeneCurve::createProblem_() const
+{
+	std::unique_ptr<MaxGeneProblem> problem(new MaxGeneProblem(mappings_, 0));
+	if(threads_ > 0) {
+		problem->setNumThreads(threads_);
+	}
+
+	if(terminate_) {
+		problem->setTerminationFlag(terminate_);
+	}
+
+	if(lagrangian_) {
+		problem->setLagrangianBound(true);
+	}
+
+	if(verbose_) {
+		std::cout << "Created ILP formulation with "
+		          << problem->numVariables() << " variables, "
+		          << problem->numConstraints() << " constraints, and "
+		          << problem->numNonZero() << " non-zero entries.\n";
+	}
+
+	return problem;
+}
+
+std::vector<ResultCache::CurvePoint>
+MaxGeneCurve::checkpoints_(std::size_t limit) const
+{
+	std::vector<ResultCache::CurvePoint> result(limit + 1);
+	if(!cache_) {
+		return result;
+	}
+
+	for(auto& point : cache_->loadCurve(mappings_.contentHash(), CURVE_KEY)) {
+		if(point.k > 0 && point.k <= limit) {
+			result[point.k] = std::move(point);
+		}
+	}
+
+	return result;
+}
+
+void MaxGeneCurve::checkpoint_(std::size_t k, std::size_t value,
+                               const std::vector<std::size_t>& mirnas,
+                               const SolveStats& stats) const
+{
+	if(!cache_ || !ResultCache::cacheable(stats)) {
+		return;
+	}
+
+	ResultCache::CurvePoint point;
+	point.k = k;
+	point.value = value;
+	point.mirnas = mirnas;
+	cache_->appendCurve(mappings_.contentHash(), CURVE_KEY, point);
+}
+
+bool MaxGeneCurve::stopped_() const
+{
+	return (terminate_ && *terminate_) ||
+	       (time_limit_ > 0.0 && std::chrono::steady_clock::now() >= deadline_);
+}
+
+bool MaxGeneCurve::applyBudget_(ILPProblem& problem) const
+{
+	if(stopped_()) {
+		return false;
+	}
+
+	SolveLimits limits = limits_;
+	if(time_limit_ > 0.0) {
+		const std::chrono::duration<double> remaining =
+		    deadline_ - std::chrono::steady_clock::now();
+		if(limits.time <= 0.0 || remaining.count() < limits.time) {
+			limits.time = remaining.count();
+		}
+	}
+
+	problem.setLimits(limits);
+
+	return true;
+}
+
+std::vector<std::size_t> MaxGeneCurve::compute()
+{
+	const std::size_t limit = std::min(max_mirnas_, mappings_.numMirnas());
+	stats_.clear();
+	complete_ = true;
+	deadline_ = std::chrono::steady_clock::now() +
+	            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+	                std::chrono::duration<double>(time_limit_));
+
+	components_.reset(new ConnectedComponents(mappings_));
+	if(components_->size() > 1) {
+		computeComponents_(limit);
+		mergeComponents_(limit);
+		return curve_;
+	}
+
+	components_.reset();
+	if(adaptive_) {
+		computeAdaptive_(limit);
+	} else if(jobs_ == 1) {
+		computeSequential_(limit);
+	} else {
+		computeParallel_(limit);
+	}
+
+	return curve_;
+}
+
+PartialCurve MaxGeneCurve::computeShard(std::size_t shard,
+                                       std::size_t num_shards)
+{
+	const std::size_t limit = std::min(max_mirnas_, mappings_.numMirnas());
+	const std::size_t num_genes = num_targets_;
+	stats_.clear();
+	complete_ = true;
+	deadline_ = std::chrono::steady_clock::now() +
+	            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+	                std::chrono::duration<double>(time_limit_));
+
+	PartialCurve result;
+	result.shard = shard;
+	result.num_shards = num_shards;
+	result.content_hash = mappings_.contentHash();
+	result.max_k = limit;
+	result.num_genes = num_genes;
+
+	std::unique_ptr<MaxGeneProblem> problem;
+	const auto points = checkpoints_(limit);
+
+	// Selections of smaller k extend to feasible ones for larger k
+	std::vector<std::size_t> previous;
+	double previous_objective = 0.0;
+
+	// Returns false if the solve was stopped before finding a solution
+	auto solve = [&](PartialCurve::Point& point) {
+		if(!problem) {
+			problem = createProblem_();
+		}
+
+		if(!applyBudget_(*problem)) {
+			return false;
+		}
+
+		if(verbose_) {
+			std::cout << "\rProcessing " << point.k << "/" << limit;
+			std::cout.flush();
+		}
+
+		problem->setNumMirna(point.k);
+		problem->warmStart(previous, previous_objective);
+		try {
+			problem->solve();
+		} catch(const CPLEXException&) {
+			// Solves cut short may not have a solution
+			if(!stopped_()) {
+				throw;
+			}
+
+			return false;
+		}
+
+		const SolveStats& stats = problem->solveStats();
+		const double bound = stats.optimal ? stats.objective : stats.bound;
+		point.lower = problem->objectiveValue();
+		point.upper = std::min<double>(num_genes, std::floor(bound + 1e-6));
+		point.status = stats.optimal ? "optimal" : "limit";
+		complete_ = complete_ && stats.optimal;
+
+		previous = problem->selectedMirnas();
+		previous_objective = problem->objectiveValue();
+		stats_.push_back(stats);
+		stats_.back().k = point.k;
+		checkpoint_(point.k, point.lower, previous, stats_.back());
+
+		return true;
+	};
+
+	bool stopped = false;
+	const std::size_t first = shard > 0 ? shard : num_shards;
+	for(std::size_t k = first; k <= limit; k += num_shards) {
+		PartialCurve::Point point{k, 0, num_genes, "unsolved"};
+
+		if(previous_objective >= num_genes) {
+			point.lower = num_genes;
+			point.status = "covered";
+		} else if(points[k].k == k) {
+			point.lower = point.upper = points[k].value;
+			point.status = "cached";
+			previous = points[k].mirnas;
+			previous_objective = points[k].value;
+			stats_.push_back(cachedStats(points[k]));
+		} else if(!stopped && !solve(point)) {
+			stopped = true;
+			complete_ = false;
+		}
+
+		result.points.push_back(point);
+	}
+
+	if(verbose_) {
+		std::cout << '\n';
+	}
+
+	return result;
+}
+
+const std::vector<SolveStats>& MaxGeneCurve::solveStats() const
+{
+	return stats_;
+}
+
+std::vector<std::size_t> MaxGeneCurve::selection(std::size_t k) const
+{
+	if(!components_) {
+		return pad_(selections_[std::min(k, num_solved_)], k);
+	}
+
+	std::vector<std::size_t> result;
+	std::size_t remaining = std::min(k, num_solved_);
+	for(size_t c = components_->size(); c-- > 0;) {
+		const std::size_t j = choices_[c][remaining];
+		const auto& mirnas = components_->mirnas(c);
+
+		for(std::size_t m : component_curves_[c]->selection(j)) {
+			result.push_back(mirnas[m]);
+		}
+
+		remaining -= j;
+	}
+
+	return pad_(std::move(result), k);
+}
+
+std::vector<std::size_t> MaxGeneCurve::pad_(std::vector<std::size_t> selection,
+                                            std::size_t k) const
+{
+	// Beyond full coverage any additional miRNAs are optimal
+	std::vector<bool> selected(mappings_.numMirnas(), false);
+	for(std::size_t m : selection) {
+		selected[m] = true;
+	}
+
+	for(size_t m = 0; m < selected.size() && selection.size() < k; ++m) {
+		if(!selected[m]) {
+			selection.push_back(m);
+		}
+	}
+
+	std::sort(selection.begin(), selection.end());
+
+	return selection;
+}
+
+void MaxGeneCurve::computeSequential_(std::size_t limit)
+{
+	curve_.assign(limit + 1, num_targets_);
+	curve_[0] = 0;
+	selections_.assign(1, {});
+	num_solved_ = 0;
+
+	// Created once the first point is not checkpointed
+	std::unique_ptr<MaxGeneProblem> problem;
+	const auto points = checkpoints_(limit);
+
+	// The optimum for k - 1 plus one more miRNA is feasible for k and
+	// its objective bounds the optimum for k from below.
+	std::vector<std::size_t> previous;
+	double previous_objective = 0.0;
+
+	for(std::size_t i = 1; i <= limit; ++i) {
+		const bool cached = points[i].k == i;
+		if(!cached && !problem) {
+			problem = createProblem_();
+		}
+
+		if(!cached && !applyBudget_(*problem)) {
+			complete_ = false;
+			curve_.resize(num_solved_ + 1);
+			break;
+		}
+
+		if(verbose_) {
+			std::cout << "\rProcessing " << i << "/" << limit;
+			std::cout.flush();
+		}
+
+		if(cached) {
+			previous = points[i].mirnas;
+			previous_objective = points[i].value;
+			curve_[i] = points[i].value;
+			stats_.push_back(cachedStats(points[i]));
+		} else {
+			problem->setNumMirna(i);
+			problem->warmStart(previous, previous_objective);
+
+			ILPProblem::Result result;
+			try {
+				result = problem->solve();
+			} catch(const CPLEXException&) {
+				// Solves cut short may not have a solution
+				if(!stopped_()) {
+					throw;
+				}
+
+				complete_ = false;
+				curve_.resize(num_solved_ + 1);
+				break;
+			}
+
+			previous = problem->selectedMirnas();
+			previous_objective = problem->objectiveValue();
+			curve_[i] = result.second.size();
+			stats_.push_back(problem->solveStats());
+			stats_.back().k = i;
+			// Solves stopped by a limit only bound the point
+			complete_ = complete_ && stats_.back().optimal;
+			checkpoint_(i, curve_[i], previous, stats_.back());
+		}
+
+		selections_.push_back(previous);
+		num_solved_ = i;
+
+		if(curve_[i] == num_targets_ && i != limit) {
+			if(verbose_) {
+				std::cout << "\nCovered all available target genes. "
+				             "Exiting early.";
+			}
+			break;
+		}
+	}
+
+	if(verbose_) {
+		std::cout << '\n';
+	}
+}
+
+void MaxGeneCurve::computeAdaptive_(std::size_t limit)
+{
+	const auto created = createProblem_();
+	MaxGeneProblem& problem = *created;
+
+	const InstanceReduction& instance = problem.reducedInstance();
+	const GreedyCover greedy(instance);
+	const std::size_t num_genes = num_targets_;
+
+	// lower[k] is the coverage of the reduced selection best[k] and
+	// upper[k] bounds the optimum for k miRNAs
+	std::vector<std::size_t> lower(limit + 1, 0);
+	std::vector<std::size_t> upper(limit + 1, num_genes);
+	std::vector<std::vector<std::size_t>> best(limit + 1);
+	std::vector<bool> attempted(limit + 1, false);
+
+	// Every prefix of the sequence is a selection of its length
+	auto improve = [&](const std::vector<std::size_t>& sequence) {
+		const auto weights = greedy.prefixWeights(sequence);
+		for(size_t k = 1; k < weights.size() && k <= limit; ++k) {
+			if(weights[k] > lower[k]) {
+				lower[k] = weights[k];
+				best[k].assign(sequence.begin(), sequence.begin() + k);
+			}
+		}
+	};
+
+	// Covering with k miRNAs yields at most the k largest target sets
+	std::vector<std::size_t> sizes(instance.numMirnas(), 0);
+	for(const auto& mapping : instance) {
+		sizes[mapping.mirna()] += instance.geneWeight(mapping.gene());
+	}
+
+	std::sort(sizes.begin(), sizes.end(), std::greater<std::size_t>());
+	upper[0] = 0;
+	std::size_t sum = 0;
+	for(size_t k = 1; k <= limit; ++k) {
+		sum += k <= sizes.size() ? sizes[k - 1] : 0;
+		upper[k] = std::min(upper[k], sum);
+	}
+
+	auto propagate = [&]() {
+		// Adding any miRNA keeps the coverage
+		for(size_t k = 1; k <= limit; ++k) {
+			if(lower[k - 1] > lower[k]) {
+				lower[k] = lower[k - 1];
+				best[k] = best[k - 1];
+			}
+		}
+
+		// Dropping the least useful of k miRNAs loses at most f(k) / k,
+		// hence f(k) <= f(k - 1) * k / (k - 1)
+		for(bool changed = true; changed;) {
+			changed = false;
+			for(size_t k = limit; k-- > 0;) {
+				if(upper[k + 1] < upper[k]) {
+					upper[k] = upper[k + 1];
+					changed = true;
+				}
+			}
+
+			for(size_t k = 2; k <= limit; ++k) {
+				const std::size_t bound = upper[k - 1] * k / (k - 1);
+				if(bound < upper[k]) {
+					upper[k] = bound;
+					changed = true;
+				}
+			}
+		}
+
+		for(size_t k = 0; k <= limit; ++k) {
+			upper[k] = std::max(upper[k], lower[k]);
+		}
+	};
+
+	auto next = [&]() {
+		std::size_t result = 0;
+		std::size_t longest = 0;
+		for(size_t k = 1; k <= limit; ++k) {
+			if(lower[k] == upper[k] || attempted[k]) {
+				continue;
+			}
+
+			if(!bisect_) {
+				return k;
+			}
+
+			std::size_t end = k;
+			while(end + 1 <= limit && lower[end + 1] < upper[end + 1] &&
+			      !attempted[end + 1]) {
+				++end;
+			}
+
+			if(end - k + 1 > longest) {
+				longest = end - k + 1;
+				result = (k + end) / 2;
+			}
+
+			k = end;
+		}
+
+		return result;
+	};
+
+	improve(greedy.maxCoverage(limit));
+
+	// Checkpointed points are exact
+	for(const auto& point : checkpoints_(limit)) {
+		if(point.k > 0) {
+			const auto selection = instance.reduceMirnas(point.mirnas);
+			improve(greedy.removalOrder(selection));
+			improve(greedy.maxCoverage(limit, selection));
+			upper[point.k] = std::min(upper[point.k], point.value);
+			attempted[point.k] = true;
+			stats_.push_back(cachedStats(point));
+		}
+	}
+
+	propagate();
+
+	// Before solving k, its Lagrangian bound may already close the gap
+	LagrangianBound lagrangian(instance);
+	std::vector<bool> bounded(limit + 1, false);
+
+	std::size_t num_ilps = 0;
+	for(std::size_t k = next(); k > 0; k = next()) {
+		if(!bounded[k]) {
+			bounded[k] = true;
+			const double bound = lagrangian.maxCoverage(k, lower[k]);
+			upper[k] = std::min<double>(upper[k], std::floor(bound + 1e-6));
+			improve(greedy.removalOrder(lagrangian.selection()));
+			improve(greedy.maxCoverage(limit, lagrangian.selection()));
+			propagate();
+
+			if(lower[k] == upper[k]) {
+				continue;
+			}
+		}
+
+		if(!applyBudget_(problem)) {
+			complete_ = false;
+			break;
+		}
+
+		if(verbose_) {
+			std::cout << "\rSolving k = " << k << ", " << num_ilps
+			          << " ILPs so far";
+			std::cout.flush();
+		}
+
+		problem.setNumMirna(k);
+		problem.warmStart(instance.expandMirnas(best[k]), lower[k]);
+
+		try {
+			problem.solve();
+		} catch(const CPLEXException&) {
+			// Solves cut short may not have a solution
+			if(!stopped_()) {
+				throw;
+			}
+
+			complete_ = false;
+			break;
+		}
+
+		attempted[k] = true;
+		++num_ilps;
+		stats_.push_back(problem.solveStats());
+		stats_.back().k = k;
+		checkpoint_(k, problem.objectiveValue(), problem.selectedMirnas(),
+		            stats_.back());
+
+		// Smaller selections follow by shrinking the solution, larger
+		// ones by extending it greedily.
+		const auto selection = instance.reduceMirnas(problem.selectedMirnas());
+		improve(greedy.removalOrder(selection));
+		improve(greedy.maxCoverage(limit, selection));
+
+		const SolveStats& stats = problem.solveStats();
+		const double bound = stats.optimal ? stats.objective : stats.bound;
+		upper[k] = std::min<double>(upper[k], std::floor(bound + 1e-6));
+		propagate();
+	}
+
+	for(size_t k = 0; k <= limit; ++k) {
+		if(lower[k] < upper[k]) {
+			complete_ = false;
+		}
+	}
+
+	if(verbose_) {
+		std::cout << "\nSolved " << num_ilps << " ILPs"
+		          << (complete_ ? ", the bounds fixed the remaining points.\n"
+		                        : ".\n");
+	}
+
+	// Beyond full coverage, further points need not be stored
+	num_solved_ = limit;
+	for(size_t k = 0; k <= limit; ++k) {
+		if(lower[k] == num_genes) {
+			num_solved_ = k;
+			break;
+		}
+	}
+
+	curve_.assign(limit + 1, num_genes);
+	std::copy(lower.begin(), lower.begin() + num_solved_ + 1, curve_.begin());
+	selections_.clear();
+	for(size_t k = 0; k <= num_solved_; ++k) {
+		selections_.push_back(instance.expandMirnas(best[k]));
+	}
+}
+
+namespace
+{
+struct CurveWorker
+{
+	volatile int terminate = 0;
+	std::atomic<std::size_t> current_k{0};
+};
+}
+
+void MaxGeneCurve::computeParallel_(std::size_t limit)
+{
+	const std::size_t num_genes = num_targets_;
+	const std::size_t jobs = std::min(jobs_, std::max<std::size_t>(limit, 1));
+
+	curve_.assign(limit + 1, num_genes);
+	curve_[0] = 0;
+	selections_.assign(limit + 1, {});
+	std::vector<bool> solved(limit + 1, false);
+	solved[0] = true;
+
+	const int threads_per_job = ILPProblem::threadsPerJob(jobs);
+
+	// Smallest k for which all genes could be covered. Every larger k is
+	// known to cover all genes and need not be solved.
+	std::atomic<std::size_t> full_k{limit + 1};
+	std::atomic<std::size_t> next_k{1};
+
+	// Checkpointed points are taken over and skipped by the workers
+	std::vector<bool> cached(limit + 1, false);
+	for(const auto& point : checkpoints_(limit)) {
+		if(point.k == 0) {
+			continue;
+		}
+
+		curve_[point.k] = point.value;
+		selections_[point.k] = point.mirnas;
+		solved[point.k] = cached[point.k] = true;
+		stats_.push_back(cachedStats(point));
+		if(point.value == num_genes) {
+			full_k = std::min<std::size_t>(full_k, point.k);
+		}
+	}
+
+	std::vector<CurveWorker> workers(jobs);
+	std::mutex mutex;
+	std::size_t num_done = 0;
+	std::exception_ptr error;
+
+	auto cancelAbove = [&](std::size_t k) {
+		std::size_t cur = full_k.load();
+		while(k < cur && !full_k.compare_exchange_weak(cur, k)) {
+		}
+
+		for(auto& w : workers) {
+			if(w.current_k.load() > full_k.load()) {
+				w.terminate = 1;
+			}
+		}
+	};
+
+	auto work = [&](CurveWorker& worker) {
+		try {
+			MaxGeneProblem problem(mappings_, 0);
+			problem.setNumThreads(threads_per_job);
+			problem.setTerminationFlag(&worker.terminate);
+			if(lagrangian_) {
+				problem.setLagrangianBound(true);
+			}
+
+			std::vector<std::size_t> previous;
+			double previous_objective = 0.0;
+
+			for(std::size_t k = next_k++;
+			    k <= limit && k < full_k && applyBudget_(problem);
+			    k = next_k++) {
+				if(cached[k]) {
+					continue;
+				}
+
+				worker.current_k = k;
+				problem.setNumMirna(k);
+				problem.warmStart(previous, previous_objective);
+
+				ILPProblem::Result result;
+				try {
+					result = problem.solve();
+				} catch(const CPLEXException&) {
+					// Aborted solves may not have a solution
+					if(k > full_k || stopped_()) {
+						break;
+					}
+					throw;
+				}
+
+				if(k > full_k) {
+					break;
+				}
+
+				previous = problem.selectedMirnas();
+				previous_objective = problem.objectiveValue();
+
+				std::lock_guard<std::mutex> lock(mutex);
+				curve_[k] = result.second.size();
+				selections_[k] = previous;
+				solved[k] = true;
+				stats_.push_back(problem.solveStats());
+				stats_.back().k = k;
+				complete_ = complete_ && stats_.back().optimal;
+				checkpoint_(k, curve_[k], previous, stats_.back());
+				if(verbose_) {
+					std::cout << "\rProcessing " << ++num_done << "/" << limit;
+					std::cout.flush();
+				}
+
+				if(curve_[k] == num_genes) {
+					cancelAbove(k);
+				}
+			}
+		} catch(...) {
+			std::lock_guard<std::mutex> lock(mutex);
+			if(!error) {
+				error = std::current_exception();
+			}
+			cancelAbove(0);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for(auto& w : workers) {
+		threads.emplace_back(work, std::ref(w));
+	}
+
+	// CPLEX polls a single flag per problem, forward external termination
+	// to the flags of the workers.
+	std::atomic<bool> done{false};
+	std::thread monitor;
+	if(terminate_) {
+		monitor = std::thread([&]() {
+			while(!done && !*terminate_) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			}
+
+			for(auto& w : workers) {
+				w.terminate = 1;
+			}
+		});
+	}
+
+	for(auto& t : threads) {
+		t.join();
+	}
+
+	done = true;
+	if(monitor.joinable()) {
+		monitor.join();
+	}
+
+	if(verbose_) {
+		std::cout << '\n';
+	}
+
+	if(error) {
+		std::rethrow_exception(error);
+	}
+
+	num_solved_ = std::min<std::size_t>(full_k, limit);
+
+	// A stopped computation leaves gaps, the curve ends before the first
+	for(size_t k = 1; k <= num_solved_; ++k) {
+		if(!solved[k]) {
+			num_solved_ = k - 1;
+			complete_ = false;
+			curve_.resize(k);
+			break;
+		}
+	}
+
+	selections_.resize(num_solved_ + 1);
+
+	if(full_k <= limit && verbose_) {
+		std::cout << "Covered all available target genes with " << full_k
+		          << " miRNAs.\n";
+	}
+}
+
+void MaxGeneCurve::computeComponents_(std::size_t limit)
+{
+	const std::size_t num_components = components_->size();
+	const std::size_t jobs = std::min(jobs_, num_components);
+
+	if(verbose_) {
+		std::cout << "Decomposed instance into " << num_components
+		          << " connected components.\n";
+	}
+
+	component_curves_.clear();
+	for(size_t c = 0; c < num_components; ++c) {
+		const TargetMappings& component = components_->mappings(c);
+		component_curves_.emplace_back(new MaxGeneCurve(component));
+		component_curves_[c]->max_mirnas_ =
+		    std::min(limit, component.numMirnas());
+		component_curves_[c]->verbose_ = false;
+		component_curves_[c]->threads_ = ILPProblem::threadsPerJob(jobs);
+		component_curves_[c]->limits_ = limits_;
+		component_curves_[c]->time_limit_ = time_limit_;
+		component_curves_[c]->terminate_ = terminate_;
+		component_curves_[c]->deadline_ = deadline_;
+		component_curves_[c]->lagrangian_ = lagrangian_;
+		component_curves_[c]->cache_ = cache_;
+	}
+
+	// Start with the largest components to balance the load
+	std::vector<std::size_t> order(num_components);
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [this](std::size_t a, std::size_t b) {
+		return components_->mappings(a).numMappings() >
+		       components_->mappings(b).numMappings();
+	});
+
+	std::atomic<std::size_t> next{0};
+	std::atomic<bool> failed{false};
+	std::mutex mutex;
+	std::size_t num_done = 0;
+	std::exception_ptr error;
+
+	auto work = [&]() {
+		try {
+			for(std::size_t i = next++; i < num_components && !failed;
+			    i = next++) {
+				MaxGeneCurve& curve = *component_curves_[order[i]];
+				if(adaptive_) {
+					curve.computeAdaptive_(curve.max_mirnas_);
+				} else {
+					curve.computeSequential_(curve.max_mirnas_);
+				}
+
+				std::lock_guard<std::mutex> lock(mutex);
+				if(verbose_) {
+					std::cout << "\rSolved " << ++num_done << "/"
+					          << num_components << " components";
+					std::cout.flush();
+				}
+			}
+		} catch(...) {
+			std::lock_guard<std::mutex> lock(mutex);
+			if(!error) {
+				error = std::current_exception();
+			}
+			failed = true;
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for(size_t i = 0; i < jobs; ++i) {
+		threads.emplace_back(work);
+	}
+
+	for(auto& t : threads) {
+		t.join();
+	}
+
+	if(verbose_) {
+		std::cout << '\n';
+	}
+
+	if(error) {
+		std::rethrow_exception(error);
+	}
+
+	for(size_t c = 0; c < num_components; ++c) {
+		complete_ = complete_ && component_curves_[c]->complete_;
+		for(auto stats : component_curves_[c]->stats_) {
+			stats.label = "component " + std::to_string(c);
+			stats_.push_back(std::move(stats));
+		}
+	}
+}
+
+void MaxGeneCurve::mergeComponents_(std::size_t limit)
+{
+	// best[k] is the maximal coverage using k miRNAs from the components
+	// merged so far. Beyond its last solved point, a component curve is
+	// flat, so only the solved points need to be considered.
+	std::vector<std::size_t> best(1, 0);
+	choices_.assign(components_->size(), {});
+
+	for(size_t c = 0; c < components_->size(); ++c) {
+		const MaxGeneCurve& curve = *component_curves_[c];
+		const std::size_t reach = best.size() - 1;
+		const std::size_t size = std::min(limit, reach + curve.num_solved_);
+
+		std::vector<std::size_t> next(size + 1, 0);
+		std::vector<std::size_t>& choice = choices_[c];
+		choice.assign(size + 1, 0);
+
+		for(size_t k = 0; k <= size; ++k) {
+			const std::size_t first = k > reach ? k - reach : 0;
+			const std::size_t last = std::min(k, curve.num_solved_);
+			for(size_t j = first; j <= last; ++j) {
+				const std::size_t value = best[k - j] + curve.curve_[j];
+				if(j == first || value > next[k]) {
+					next[k] = value;
+					choice[k] = j;
+				}
+			}
+		}
+
+		best = std::move(next);
+	}
+
+	// Once all components are covered, additional miRNAs change nothing.
+	// This does not hold if a component curve has been cut short.
+	num_solved_ = best.size() - 1;
+	curve_.assign(complete_ ? limit + 1 : best.size(), best.back());
+	std::copy(best.begin(), best.end(), curve_.begin());
+}
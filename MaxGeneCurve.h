@@ -0,0 +1,151 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MAXGENECURVE_H
+#define MAXGENECURVE_H
+
+#include "ConnectedComponents.h"
+#include "ILPProblem.h"
+#include "PartialCurve.h"
+#include "ResultCache.h"
+#include "TargetMappings.h"
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+class MaxGeneProblem;
+
+/**
+ * Computes the maximal number of genes that can be covered by k miRNAs
+ * for every k between 0 and the number of miRNAs.
+ *
+ * If the instance consists of multiple connected components, the curve of
+ * every component is computed separately and the curves are merged by a
+ * knapsack-style dynamic program, which is exact as coverage is additive
+ * over components.
+ */
+class MaxGeneCurve
+{
+  public:
+	explicit MaxGeneCurve(const TargetMappings& mappings);
+
+	void setNumJobs(std::size_t jobs);
+	/// CPLEX threads of every solve, the default of CPLEX if 0.
+	void setNumThreads(int threads);
+	/// Only computes the curve up to k miRNAs.
+	void setMaxMirnas(std::size_t k);
+	void setVerbose(bool verbose);
+	/// Budgets of every single solve.
+	void setSolveLimits(const SolveLimits& limits);
+	/**
+	 * Stops computing the curve after the given wall-clock seconds, or as
+	 * soon as *flag becomes non-zero. Running solves return their best
+	 * incumbent and the curve ends at the largest k solved so far.
+	 */
+	void setTimeLimit(double seconds);
+	void setTerminationFlag(volatile int* flag);
+	/// Bounds every curve point by Lagrangian relaxation, see
+	/// MaxGeneProblem::setLagrangianBound().
+	void setLagrangianBound(bool enable);
+	/**
+	 * Only solves the ILP for points whose cheap bounds disagree. Lower
+	 * bounds stem from greedy covers and from growing or shrinking solved
+	 * selections. Upper bounds stem from the best single miRNAs, from
+	 * monotonicity and from f(k) / k not increasing in k. Unresolved points
+	 * are solved in increasing order or, with bisect, in the middle of the
+	 * longest unresolved stretch.
+	 */
+	void setAdaptive(bool adaptive, bool bisect = false);
+	/**
+	 * Checkpoints every optimally solved point to the cache, such that a
+	 * later computation on the same mappings resumes from the solved
+	 * points. Components are checkpointed separately.
+	 */
+	void setCache(const ResultCache* cache);
+
+	/// Whether the last call to compute() reached the maximal k. Points of
+	/// an incomplete curve that depend on unsolved ones are lower bounds.
+	bool complete() const;
+
+	std::vector<std::size_t> compute();
+	/**
+	 * Only solves the points assigned to the given shard, see PartialCurve,
+	 * in increasing order on the whole instance. Points beyond one that
+	 * covers all genes are not solved. Points not solved optimally keep the
+	 * bounds known when the solve stopped.
+	 */
+	PartialCurve computeShard(std::size_t shard, std::size_t num_shards);
+
+	/// Original indices of an optimal selection of k miRNAs. Requires a
+	/// prior call to compute() with k not exceeding the maximal number of
+	/// miRNAs.
+	std::vector<std::size_t> selection(std::size_t k) const;
+
+	/// Statistics of every solve of the last call to compute(), with k
+	/// set. Solves of connected components are labelled with the index of
+	/// the component and k is relative to the component.
+	const std::vector<SolveStats>& solveStats() const;
+
+  private:
+	const TargetMappings& mappings_;
+	// Genes with at least one target, i.e. full coverage
+	std::size_t num_targets_;
+	std::size_t jobs_;
+	std::size_t max_mirnas_;
+	int threads_;
+	bool verbose_;
+
+	SolveLimits limits_;
+	double time_limit_;
+	volatile int* terminate_;
+	bool lagrangian_;
+	bool adaptive_;
+	bool bisect_;
+	const ResultCache* cache_;
+	std::chrono::steady_clock::time_point deadline_;
+	bool complete_;
+
+	std::vector<std::size_t> curve_;
+	// Largest k that has actually been solved
+	std::size_t num_solved_;
+	std::vector<std::vector<std::size_t>> selections_;
+	std::vector<SolveStats> stats_;
+
+	std::unique_ptr<ConnectedComponents> components_;
+	std::vector<std::unique_ptr<MaxGeneCurve>> component_curves_;
+	// Number of miRNAs assigned to component c for a total of k miRNAs
+	std::vector<std::vector<std::size_t>> choices_;
+
+	std::unique_ptr<MaxGeneProblem> createProblem_() const;
+	/// Checkpointed points indexed by k, missing points have k = 0.
+	std::vector<ResultCache::CurvePoint> checkpoints_(std::size_t limit) const;
+	void checkpoint_(std::size_t k, std::size_t value,
+	                 const std::vector<std::size_t>& mirnas,
+	                 const SolveStats& stats) const;
+	bool stopped_() const;
+	bool applyBudget_(ILPProblem& problem) const;
+	void computeSequential_(std::size_t limit);
+	void computeAdaptive_(std::size_t limit);
+	void computeParallel_(std::size_t limit);
+	void computeComponents_(std::size_t limit);
+	void mergeComponents_(std::size_t limit);
+	std::vector<std::size_t> pad_(std::vector<std::size_t> selection,
+	                              std::size_t k) const;
+};
+
+#endif // MAXGENECURVE_H
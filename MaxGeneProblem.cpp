@@ -19,43 +19,103 @@
 
 #include <array>
 #include <algorithm>
+#include <limits>
+#include <numeric>
 
 MaxGeneProblem::MaxGeneProblem(const TargetMappings& mappings,
                                std::size_t num_mirnas)
-    : ILPProblem(mappings), num_mirnas_(num_mirnas)
+    : ILPProblem(mappings),
+      num_mirnas_(num_mirnas),
+      lagrangian_bound_(std::numeric_limits<double>::infinity()),
+      heuristic_objective_(0.0)
 {
 	createProblem_();
+	createGreedyStart_();
 }
 
 MaxGeneProblem::MaxGeneProblem(TargetMappings&& mappings,
                                std::size_t num_mirnas)
-    : ILPProblem(std::move(mappings)), num_mirnas_(num_mirnas)
+    : ILPProblem(std::move(mappings)),
+      num_mirnas_(num_mirnas),
+      lagrangian_bound_(std::numeric_limits<double>::infinity()),
+      heuristic_objective_(0.0)
 {
 	createProblem_();
+	createGreedyStart_();
 }
 
 void MaxGeneProblem::setNumMirna(size_t k)
 {
+	num_mirnas_ = k;
+
 	const int idx = 0;
 	const double value = k;
 	handleCPLEXError_(CPXchgrhs(env_, lp_, 1, &idx, &value));
+
+	createGreedyStart_();
+}
+
+void MaxGeneProblem::warmStart(const std::vector<std::size_t>& mirnas,
+                               double cutoff)
+{
+	addMipStart_(
+	    greedy_->maxCoverage(num_mirnas_, instance_->reduceMirnas(mirnas)));
+	setLowerCutoff_(cutoff);
+}
+
+void MaxGeneProblem::setLagrangianBound(bool enable)
+{
+	if(enable) {
+		lagrangian_.reset(new LagrangianBound(*instance_));
+	} else {
+		lagrangian_.reset();
+	}
+
+	createGreedyStart_();
+}
+
+double MaxGeneProblem::lagrangianBound() const { return lagrangian_bound_; }
+
+double MaxGeneProblem::heuristicObjective() const
+{
+	return heuristic_objective_;
+}
+
+void MaxGeneProblem::createGreedyStart_()
+{
+	clearMipStarts_();
+
+	const auto greedy = greedy_->maxCoverage(num_mirnas_);
+	addMipStart_(greedy);
+	heuristic_objective_ = greedy_->coveredWeight(greedy);
+
+	lagrangian_bound_ = std::numeric_limits<double>::infinity();
+	if(lagrangian_) {
+		lagrangian_bound_ =
+		    lagrangian_->maxCoverage(num_mirnas_, heuristic_objective_);
+		if(lagrangian_->lowerBound() > heuristic_objective_) {
+			heuristic_objective_ = lagrangian_->lowerBound();
+			addMipStart_(lagrangian_->selection());
+		}
+	}
+
+	setKnownBound_(lagrangian_bound_);
 }
 
 void MaxGeneProblem::createObjectiveFunction_()
 {
-	const std::size_t nvar = mappings_.numGenes() + mappings_.numMirnas();
+	const std::size_t num_mirnas = instance_->numMirnas();
+	const std::size_t nvar = instance_->numGenes() + num_mirnas;
 
 	int status = CPXchgobjsen(env_, lp_, CPX_MAX);
 	handleCPLEXError_(status);
 
-	std::vector<char> ctype(nvar, 'B');
-	std::vector<double> row(nvar, 1.0);
-
-	std::fill_n(row.begin(), mappings_.numMirnas(), 0.0);
+	std::vector<double> row(nvar, 0.0);
+	for(size_t i = num_mirnas; i < nvar; ++i) {
+		row[i] = instance_->geneWeight(i - num_mirnas);
+	}
 
-	status = CPXnewcols(env_, lp_, nvar, &row[0], nullptr, nullptr, &ctype[0],
-	                    nullptr);
-	handleCPLEXError_(status);
+	createColumns_(row);
 }
 
 void MaxGeneProblem::createConstraints_()
@@ -66,7 +126,7 @@ void MaxGeneProblem::createConstraints_()
 
 void MaxGeneProblem::createNumMirnaConstraint_()
 {
-	const std::size_t nvar = mappings_.numMirnas();
+	const std::size_t nvar = instance_->numMirnas();
 
 	const char sense = 'E';
 	const double rhs = num_mirnas_;
@@ -81,3 +141,21 @@ void MaxGeneProblem::createNumMirnaConstraint_()
 	                        &indices[0], &row[0], nullptr, nullptr);
 	handleCPLEXError_(status);
 }
+
+std::vector<std::size_t>
+MaxGeneProblem::round_(const std::vector<double>& x,
+                       std::mt19937_64& rng) const
+{
+	// Dependent rounding keeps the selection at k miRNAs up to numerical
+	// noise, which the greedy repair or the truncation take care of.
+	std::vector<std::size_t> selection = roundDependently_(x, rng);
+	selection.resize(std::min(selection.size(), num_mirnas_));
+
+	return greedy_->maxCoverage(num_mirnas_, std::move(selection));
+}
+
+double
+MaxGeneProblem::evaluate_(const std::vector<std::size_t>& selection) const
+{
+	return greedy_->coveredWeight(selection);
+}
@@ -19,6 +19,9 @@
 #define MAXGENEPROBLEM_H
 
 #include "ILPProblem.h"
+#include "LagrangianBound.h"
+
+#include <memory>
 
 class MaxGeneProblem : public ILPProblem
 {
@@ -27,15 +30,42 @@ class MaxGeneProblem : public ILPProblem
 	                        std::size_t num_mirnas);
 	explicit MaxGeneProblem(TargetMappings&& mappings, std::size_t num_mirnas);
 
+	/// Changes k and replaces the MIP start with a greedy solution.
 	void setNumMirna(std::size_t k);
 
+	/**
+	 * Adds another MIP start for the next solve. The passed selection,
+	 * usually the optimum for a smaller k, is extended greedily to the
+	 * current number of miRNAs. The cutoff must be a valid lower bound on
+	 * the optimal objective, e.g. the objective for a smaller k.
+	 */
+	void warmStart(const std::vector<std::size_t>& mirnas, double cutoff);
+
+	/**
+	 * Bounds the optimum for the current and every later k by Lagrangian
+	 * relaxation. The best solution found along the way becomes another
+	 * MIP start, and solves stop once their incumbent reaches the bound.
+	 */
+	void setLagrangianBound(bool enable);
+	/// Lagrangian bound for the current k, infinity if disabled.
+	double lagrangianBound() const;
+	/// Objective of the best solution known before solving.
+	double heuristicObjective() const;
+
   protected:
 	virtual void createObjectiveFunction_();
 	virtual void createConstraints_();
 	void createNumMirnaConstraint_();
+	void createGreedyStart_();
+	virtual std::vector<std::size_t>
+	round_(const std::vector<double>& x, std::mt19937_64& rng) const;
+	virtual double evaluate_(const std::vector<std::size_t>& selection) const;
 
   private:
 	size_t num_mirnas_;
+	std::unique_ptr<LagrangianBound> lagrangian_;
+	double lagrangian_bound_;
+	double heuristic_objective_;
 };
 
 #endif // MAXGENEPROBLEM_H
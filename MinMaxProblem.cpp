@@ -27,6 +27,7 @@ MinMaxProblem::MinMaxProblem(const TargetMappings& mappings,
       gene_weight_(gene_weight)
 {
 	createProblem_();
+	createGreedyStart_();
 }
 
 MinMaxProblem::MinMaxProblem(TargetMappings&& mappings, double mirna_weight,
@@ -36,23 +37,77 @@ MinMaxProblem::MinMaxProblem(TargetMappings&& mappings, double mirna_weight,
       gene_weight_(gene_weight)
 {
 	createProblem_();
+	createGreedyStart_();
 }
 
 void MinMaxProblem::createObjectiveFunction_()
 {
-	const std::size_t nvar = mappings_.numGenes() + mappings_.numMirnas();
+	const std::size_t num_mirnas = instance_->numMirnas();
+	const std::size_t nvar = instance_->numGenes() + num_mirnas;
 
 	int status = CPXchgobjsen(env_, lp_, CPX_MAX);
 	handleCPLEXError_(status);
 
-	std::vector<char> ctype(nvar, 'B');
-	std::vector<double> row(nvar, gene_weight_);
+	std::vector<double> row(nvar, -mirna_weight_);
+	for(size_t i = num_mirnas; i < nvar; ++i) {
+		row[i] = gene_weight_ * instance_->geneWeight(i - num_mirnas);
+	}
 
-	std::fill_n(row.begin(), mappings_.numMirnas(), -mirna_weight_);
+	createColumns_(row);
+}
+
+void MinMaxProblem::setWeights(double mirna_weight, double gene_weight)
+{
+	mirna_weight_ = mirna_weight;
+	gene_weight_ = gene_weight;
+
+	const std::size_t num_mirnas = instance_->numMirnas();
+	const std::size_t nvar = instance_->numGenes() + num_mirnas;
+
+	std::vector<int> indices(nvar);
+	std::vector<double> row(nvar, -mirna_weight_);
+	for(size_t i = 0; i < nvar; ++i) {
+		indices[i] = i;
+		if(i >= num_mirnas) {
+			row[i] = gene_weight_ * instance_->geneWeight(i - num_mirnas);
+		}
+	}
 
-	status = CPXnewcols(env_, lp_, nvar, &row[0], nullptr, nullptr, &ctype[0],
-	                    nullptr);
+	int status = CPXchgobj(env_, lp_, nvar, &indices[0], &row[0]);
 	handleCPLEXError_(status);
+
+	createGreedyStart_();
+}
+
+void MinMaxProblem::warmStart(const std::vector<std::size_t>& mirnas)
+{
+	const auto selection = greedy_->weightedCoverage(
+	    mirna_weight_, gene_weight_, instance_->reduceMirnas(mirnas));
+	addMipStart_(greedy_->prune(mirna_weight_, gene_weight_, selection));
 }
 
 void MinMaxProblem::createConstraints_() { createMappingConstraints_(); }
+
+void MinMaxProblem::createGreedyStart_()
+{
+	clearMipStarts_();
+	addMipStart_(greedy_->weightedCoverage(mirna_weight_, gene_weight_));
+}
+
+std::vector<std::size_t>
+MinMaxProblem::round_(const std::vector<double>& x, std::mt19937_64& rng) const
+{
+	// Rounding may pick miRNAs that do not pay off or miss profitable
+	// ones, both are repaired greedily.
+	std::vector<std::size_t> selection = greedy_->weightedCoverage(
+	    mirna_weight_, gene_weight_, roundIndependently_(x, rng));
+
+	return greedy_->prune(mirna_weight_, gene_weight_, std::move(selection));
+}
+
+double
+MinMaxProblem::evaluate_(const std::vector<std::size_t>& selection) const
+{
+	return gene_weight_ * greedy_->coveredWeight(selection) -
+	       mirna_weight_ * selection.size();
+}
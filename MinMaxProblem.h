@@ -31,9 +31,20 @@ class MinMaxProblem : public ILPProblem
 	MinMaxProblem(TargetMappings&& mappings, double mirna_weight,
 	              double gene_weight);
 
+	/// Changes the weights of the existing formulation, only the objective
+	/// coefficients and the greedy start are updated.
+	void setWeights(double mirna_weight, double gene_weight);
+	/// Adds a MIP start from the given original miRNA indices, which is
+	/// improved greedily for the current weights first.
+	void warmStart(const std::vector<std::size_t>& mirnas);
+
   private:
 	virtual void createObjectiveFunction_();
 	virtual void createConstraints_();
+	void createGreedyStart_();
+	virtual std::vector<std::size_t>
+	round_(const std::vector<double>& x, std::mt19937_64& rng) const;
+	virtual double evaluate_(const std::vector<std::size_t>& selection) const;
 
 	double mirna_weight_;
 	double gene_weight_;
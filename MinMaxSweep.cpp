@@ -0,0 +1,173 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "MinMaxSweep.h"
+
+#include "CPLEXException.h"
+#include "MinMaxProblem.h"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <utility>
+
+MinMaxSweep::MinMaxSweep(const TargetMappings& mappings)
+    : mappings_(mappings),
+      verbose_(true),
+      terminate_(nullptr),
+      complete_(true)
+{
+}
+
+void MinMaxSweep::setVerbose(bool verbose) { verbose_ = verbose; }
+
+void MinMaxSweep::setSolveLimits(const SolveLimits& limits)
+{
+	limits_ = limits;
+}
+
+void MinMaxSweep::setTerminationFlag(volatile int* flag)
+{
+	terminate_ = flag;
+}
+
+bool MinMaxSweep::complete() const { return complete_; }
+
+const std::vector<SolveStats>& MinMaxSweep::solveStats() const
+{
+	return stats_;
+}
+
+const std::vector<MinMaxSweep::Point>& MinMaxSweep::compute()
+{
+	points_.assign(1, Point{0, 0, {}});
+	stats_.clear();
+	complete_ = true;
+
+	const std::size_t num_mirnas = mappings_.numMirnas();
+	if(mappings_.numGenes() == 0) {
+		return points_;
+	}
+
+	// Any gene outweighs all miRNAs, which yields the last point: all
+	// genes covered by as few miRNAs as possible.
+	MinMaxProblem problem(mappings_, 1.0, num_mirnas + 1.0);
+	if(verbose_) {
+		std::cout << "Created ILP formulation with " << problem.numVariables()
+		          << " variables, " << problem.numConstraints()
+		          << " constraints, and " << problem.numNonZero()
+		          << " non-zero entries.\n";
+	}
+
+	SolveLimits limits = limits_;
+	if(limits.gap <= 0.0) {
+		limits.gap = 1e-12;
+	}
+	problem.setLimits(limits);
+
+	if(terminate_) {
+		problem.setTerminationFlag(terminate_);
+	}
+
+	// Returns false if the solve did not prove optimality
+	auto solve = [&](double mirna_weight, double gene_weight, Point& point) {
+		ILPProblem::Result result;
+		try {
+			result = problem.solve();
+		} catch(const CPLEXException&) {
+			// Solves cut short may not have a solution
+			if(!terminate_ || !*terminate_) {
+				throw;
+			}
+
+			return false;
+		}
+
+		std::ostringstream label;
+		label << mirna_weight << ' ' << gene_weight;
+		stats_.push_back(problem.solveStats());
+		stats_.back().label = label.str();
+
+		point.mirnas = result.first.size();
+		point.genes = result.second.size();
+		point.selection = problem.selectedMirnas();
+
+		return problem.solveStats().optimal;
+	};
+
+	Point last;
+	if(!solve(1.0, num_mirnas + 1.0, last)) {
+		complete_ = false;
+		return points_;
+	}
+
+	// Segments between neighbouring points still to be checked, the
+	// points found so far are kept in order of the number of miRNAs.
+	std::vector<Point> found;
+	std::vector<std::pair<Point, Point>> segments;
+	segments.emplace_back(points_.front(), std::move(last));
+	found.push_back(segments.back().second);
+
+	while(!segments.empty()) {
+		const auto segment = std::move(segments.back());
+		segments.pop_back();
+		const Point& left = segment.first;
+		const Point& right = segment.second;
+
+		// Both points have the same objective for these weights
+		const double mirna_weight = double(right.genes) - left.genes;
+		const double gene_weight = double(right.mirnas) - left.mirnas;
+		auto objective = [&](const Point& p) {
+			return gene_weight * p.genes - mirna_weight * p.mirnas;
+		};
+
+		if(verbose_) {
+			std::cout << "\rFound " << found.size() + 1 << " points after "
+			          << stats_.size() << " solves";
+			std::cout.flush();
+		}
+
+		problem.setWeights(mirna_weight, gene_weight);
+		problem.warmStart(left.selection);
+		problem.warmStart(right.selection);
+
+		Point point;
+		if(!solve(mirna_weight, gene_weight, point)) {
+			complete_ = false;
+			break;
+		}
+
+		// Objectives are integral, anything better lies above the segment
+		if(objective(point) > objective(left) + 0.5) {
+			found.push_back(point);
+			segments.emplace_back(point, right);
+			segments.emplace_back(left, std::move(point));
+		}
+	}
+
+	if(verbose_) {
+		std::cout << '\n';
+	}
+
+	auto byMirnas = [](const Point& a, const Point& b) {
+		return a.mirnas < b.mirnas;
+	};
+	std::sort(found.begin(), found.end(), byMirnas);
+	points_.insert(points_.end(), found.begin(), found.end());
+
+	return points_;
+}
@@ -0,0 +1,83 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MINMAXSWEEP_H
+#define MINMAXSWEEP_H
+
+#include "ILPProblem.h"
+#include "TargetMappings.h"
+
+#include <vector>
+
+/**
+ * Computes every supported Pareto-optimal trade-off between the number of
+ * selected miRNAs and the number of covered genes, i.e. the vertices of the
+ * upper convex hull of all (miRNAs, genes) pairs. These are exactly the
+ * solutions minmax yields for some ratio of the miRNA and gene weights.
+ *
+ * The front is found by dichotomic search: for two neighbouring points the
+ * weights are chosen such that both have the same objective. Either the
+ * optimum for these weights is a new point between them or the two are
+ * adjacent on the hull. A front of p points thus takes 2p - 2 solves, all
+ * of them on one formulation whose objective coefficients are changed in
+ * place and which is warm started from the two neighbours.
+ */
+class MinMaxSweep
+{
+  public:
+	struct Point
+	{
+		std::size_t mirnas;
+		std::size_t genes;
+		/// Original indices of the selected miRNAs.
+		std::vector<std::size_t> selection;
+	};
+
+	explicit MinMaxSweep(const TargetMappings& mappings);
+
+	void setVerbose(bool verbose);
+	/// Budgets of every single solve. The relative gap defaults to zero as
+	/// the weights are large integers and the default gap of CPLEX would
+	/// miss points.
+	void setSolveLimits(const SolveLimits& limits);
+	/// Stops as soon as *flag becomes non-zero.
+	void setTerminationFlag(volatile int* flag);
+
+	/// Whether every solve of the last call to compute() was optimal, else
+	/// the front may lack points.
+	bool complete() const;
+
+	/// Points ordered by increasing number of miRNAs, starting with the
+	/// empty selection.
+	const std::vector<Point>& compute();
+
+	/// Statistics of every solve of the last call to compute(), labelled
+	/// with the miRNA and gene weight.
+	const std::vector<SolveStats>& solveStats() const;
+
+  private:
+	const TargetMappings& mappings_;
+	bool verbose_;
+	SolveLimits limits_;
+	volatile int* terminate_;
+	bool complete_;
+
+	std::vector<Point> points_;
+	std::vector<SolveStats> stats_;
+};
+
+#endif // MINMAXSWEEP_H
@@ -0,0 +1,157 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "MinMirnaProblem.h"
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+
+MinMirnaProblem::MinMirnaProblem(const TargetMappings& mappings,
+                                 std::size_t num_genes)
+    : ILPProblem(mappings), num_genes_(num_genes)
+{
+	createProblem_();
+	findForcedMirnas_();
+	setNumGenes(num_genes);
+}
+
+MinMirnaProblem::MinMirnaProblem(TargetMappings&& mappings,
+                                 std::size_t num_genes)
+    : ILPProblem(std::move(mappings)), num_genes_(num_genes)
+{
+	createProblem_();
+	findForcedMirnas_();
+	setNumGenes(num_genes);
+}
+
+void MinMirnaProblem::setNumGenes(std::size_t num_genes)
+{
+	num_genes_ = std::min(num_genes, mappings_.numGenes());
+
+	const int idx = 0;
+	const double value = num_genes_;
+	handleCPLEXError_(CPXchgrhs(env_, lp_, 1, &idx, &value));
+
+	// Only when every gene needs to be covered, the sole regulator of a
+	// gene is part of every feasible solution.
+	fixForcedMirnas_(num_genes_ == mappings_.numGenes());
+	createGreedyStart_();
+}
+
+void MinMirnaProblem::warmStart(const std::vector<std::size_t>& mirnas)
+{
+	addMipStart_(
+	    greedy_->setCover(num_genes_, instance_->reduceMirnas(mirnas)));
+}
+
+void MinMirnaProblem::createObjectiveFunction_()
+{
+	const std::size_t nvar = instance_->numGenes() + instance_->numMirnas();
+
+	int status = CPXchgobjsen(env_, lp_, CPX_MIN);
+	handleCPLEXError_(status);
+
+	std::vector<double> row(nvar, 0.0);
+	std::fill_n(row.begin(), instance_->numMirnas(), 1.0);
+
+	createColumns_(row);
+}
+
+void MinMirnaProblem::createConstraints_()
+{
+	createCoverageConstraint_();
+	createMappingConstraints_();
+}
+
+void MinMirnaProblem::createCoverageConstraint_()
+{
+	const std::size_t nvar = instance_->numGenes();
+
+	const char sense = 'G';
+	const double rhs = num_genes_;
+	std::vector<int> indices(nvar);
+	std::vector<double> row(nvar);
+	std::array<int, 2> rmatbeg = {0, static_cast<int>(nvar)};
+
+	std::iota(indices.begin(), indices.end(), instance_->numMirnas());
+	for(size_t i = 0; i < nvar; ++i) {
+		row[i] = instance_->geneWeight(i);
+	}
+
+	int status = CPXaddrows(env_, lp_, 0, 1, nvar, &rhs, &sense, &rmatbeg[0],
+	                        &indices[0], &row[0], nullptr, nullptr);
+	handleCPLEXError_(status);
+}
+
+void MinMirnaProblem::createGreedyStart_()
+{
+	std::vector<std::size_t> forced;
+	if(num_genes_ == mappings_.numGenes()) {
+		forced.assign(forced_mirnas_.begin(), forced_mirnas_.end());
+	}
+
+	clearMipStarts_();
+	addMipStart_(greedy_->setCover(num_genes_, std::move(forced)));
+}
+
+void MinMirnaProblem::findForcedMirnas_()
+{
+	const InstanceReduction& instance = *instance_;
+	const auto& offsets = instance.geneOffsets();
+	std::vector<bool> forced(instance.numMirnas(), false);
+
+	for(size_t g = 0; g < instance.numGenes(); ++g) {
+		if(offsets[g + 1] - offsets[g] == 1) {
+			forced[instance.geneMirnas()[offsets[g]]] = true;
+		}
+	}
+
+	forced_mirnas_.clear();
+	for(size_t i = 0; i < forced.size(); ++i) {
+		if(forced[i]) {
+			forced_mirnas_.push_back(i);
+		}
+	}
+}
+
+void MinMirnaProblem::fixForcedMirnas_(bool fix)
+{
+	if(forced_mirnas_.empty()) {
+		return;
+	}
+
+	const std::vector<char> lu(forced_mirnas_.size(), 'L');
+	const std::vector<double> bd(forced_mirnas_.size(), fix ? 1.0 : 0.0);
+
+	int status = CPXchgbds(env_, lp_, forced_mirnas_.size(), &forced_mirnas_[0],
+	                       &lu[0], &bd[0]);
+	handleCPLEXError_(status);
+}
+
+std::vector<std::size_t>
+MinMirnaProblem::round_(const std::vector<double>& x,
+                        std::mt19937_64& rng) const
+{
+	return greedy_->setCover(num_genes_, roundIndependently_(x, rng));
+}
+
+double
+MinMirnaProblem::evaluate_(const std::vector<std::size_t>& selection) const
+{
+	return selection.size();
+}
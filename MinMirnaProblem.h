@@ -0,0 +1,55 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MINMIRNAPROBLEM_H
+#define MINMIRNAPROBLEM_H
+
+#include "ILPProblem.h"
+
+/**
+ * Computes the minimal number of miRNAs needed for covering at least
+ * num_genes genes.
+ */
+class MinMirnaProblem : public ILPProblem
+{
+  public:
+	MinMirnaProblem(const TargetMappings& mappings, std::size_t num_genes);
+	MinMirnaProblem(TargetMappings&& mappings, std::size_t num_genes);
+
+	/// Changes the coverage target and installs a greedy MIP start.
+	void setNumGenes(std::size_t num_genes);
+
+	/// Adds the given selection, greedily extended to the current
+	/// coverage target, as another MIP start.
+	void warmStart(const std::vector<std::size_t>& mirnas);
+
+  private:
+	virtual void createObjectiveFunction_();
+	virtual void createConstraints_();
+	void createCoverageConstraint_();
+	void createGreedyStart_();
+	virtual std::vector<std::size_t>
+	round_(const std::vector<double>& x, std::mt19937_64& rng) const;
+	virtual double evaluate_(const std::vector<std::size_t>& selection) const;
+	void findForcedMirnas_();
+	void fixForcedMirnas_(bool fix);
+
+	std::size_t num_genes_;
+	std::vector<int> forced_mirnas_;
+};
+
+#endif // MINMIRNAPROBLEM_H
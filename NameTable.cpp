@@ -0,0 +1,90 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "NameTable.h"
+
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+NameTable::NameTable() : offsets_(std::vector<std::uint64_t>(1, 0))
+{
+	rehash_(1024);
+}
+
+NameTable::NameTable(Buffer<char> arena, Buffer<std::uint64_t> offsets)
+    : arena_(std::move(arena)), offsets_(std::move(offsets))
+{
+	std::size_t capacity = 1024;
+	while(capacity < 2 * size()) {
+		capacity *= 2;
+	}
+
+	rehash_(capacity);
+}
+
+std::size_t NameTable::slot_(std::string_view name) const
+{
+	// Linear probing, the table is at most half full
+	const std::size_t mask = slots_.size() - 1;
+	std::size_t i = std::hash<std::string_view>()(name) & mask;
+	while(slots_[i] != empty_ && (*this)[slots_[i]] != name) {
+		i = (i + 1) & mask;
+	}
+
+	return i;
+}
+
+std::size_t NameTable::insert(std::string_view name)
+{
+	std::size_t i = slot_(name);
+	if(slots_[i] != empty_) {
+		return slots_[i];
+	}
+
+	const std::size_t id = size();
+	if(id >= std::numeric_limits<std::uint32_t>::max()) {
+		throw std::length_error("Too many names.");
+	}
+
+	auto& arena = arena_.edit();
+	arena.insert(arena.end(), name.begin(), name.end());
+	offsets_.edit().push_back(arena.size());
+
+	if(2 * size() > slots_.size()) {
+		rehash_(2 * slots_.size());
+	} else {
+		slots_[i] = id;
+	}
+
+	return id;
+}
+
+std::size_t NameTable::find(std::string_view name) const
+{
+	const std::size_t i = slot_(name);
+
+	return slots_[i] == empty_ ? npos : slots_[i];
+}
+
+void NameTable::rehash_(std::size_t capacity)
+{
+	slots_.assign(capacity, empty_);
+	for(std::size_t id = 0; id < size(); ++id) {
+		slots_[slot_((*this)[id])] = id;
+	}
+}
@@ -0,0 +1,68 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MINMAX_NAMETABLE_H
+#define MINMAX_NAMETABLE_H
+
+#include "Buffer.h"
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/**
+ * Assigns consecutive ids to names. All names are stored back to back in a
+ * single character arena, name i spanning [offsets[i], offsets[i + 1]).
+ * Lookups use an open addressing index over the ids.
+ */
+class NameTable
+{
+  public:
+	static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+	NameTable();
+	/// Adopts an existing arena, e.g. from a binary mappings file.
+	NameTable(Buffer<char> arena, Buffer<std::uint64_t> offsets);
+
+	std::size_t size() const { return offsets_.size() - 1; }
+
+	std::string_view operator[](std::size_t i) const
+	{
+		return std::string_view(arena_.data() + offsets_[i],
+		                        offsets_[i + 1] - offsets_[i]);
+	}
+
+	/// Returns the id of name, assigning a new one if name is unknown.
+	std::size_t insert(std::string_view name);
+	/// Returns the id of name or npos.
+	std::size_t find(std::string_view name) const;
+
+	const Buffer<char>& arena() const { return arena_; }
+	const Buffer<std::uint64_t>& offsets() const { return offsets_; }
+
+  private:
+	static constexpr std::uint32_t empty_ = ~std::uint32_t(0);
+
+	Buffer<char> arena_;
+	Buffer<std::uint64_t> offsets_;
+	std::vector<std::uint32_t> slots_;
+
+	std::size_t slot_(std::string_view name) const;
+	void rehash_(std::size_t capacity);
+};
+
+#endif // MINMAX_NAMETABLE_H
@@ -0,0 +1,155 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "PartialCurve.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+const char* const MAGIC = "maxgene-curve-shard";
+}
+
+void writePartialCurve(const std::string& path, const PartialCurve& curve)
+{
+	std::ofstream output(path);
+	if(!output) {
+		throw std::runtime_error("Could not open file '" + path +
+		                         "' for writing.");
+	}
+
+	output << MAGIC << '\t' << curve.shard << '\t' << curve.num_shards << '\t'
+	       << std::hex << curve.content_hash << std::dec << '\t'
+	       << curve.max_k << '\t' << curve.num_genes << '\n';
+
+	for(const auto& p : curve.points) {
+		output << p.k << '\t' << p.lower << '\t' << p.upper << '\t'
+		       << p.status << '\n';
+	}
+
+	output.close();
+	if(!output) {
+		throw std::runtime_error("Error while writing '" + path + "'.");
+	}
+}
+
+PartialCurve readPartialCurve(const std::string& path)
+{
+	std::ifstream input(path);
+	if(!input) {
+		throw std::runtime_error("Could not open file '" + path +
+		                         "' for reading.");
+	}
+
+	PartialCurve curve;
+	std::string magic;
+	if(!(input >> magic >> curve.shard >> curve.num_shards >> std::hex >>
+	     curve.content_hash >> std::dec >> curve.max_k >> curve.num_genes) ||
+	   magic != MAGIC || curve.shard >= curve.num_shards) {
+		throw std::runtime_error("File '" + path +
+		                         "' is not a maxgene curve shard.");
+	}
+
+	std::string line;
+	std::getline(input, line);
+	while(std::getline(input, line)) {
+		if(line.empty()) {
+			continue;
+		}
+
+		std::istringstream fields(line);
+		PartialCurve::Point p;
+		if(!(fields >> p.k >> p.lower >> p.upper >> p.status) ||
+		   p.k == 0 || p.k > curve.max_k ||
+		   p.k % curve.num_shards != curve.shard || p.lower > p.upper) {
+			throw std::runtime_error("Invalid point '" + line + "' in '" +
+			                         path + "'.");
+		}
+
+		curve.points.push_back(std::move(p));
+	}
+
+	return curve;
+}
+
+void mergePartialCurves(const std::vector<PartialCurve>& shards,
+                        std::vector<std::size_t>& lower,
+                        std::vector<std::size_t>& upper)
+{
+	if(shards.empty()) {
+		throw std::runtime_error("No shards to merge.");
+	}
+
+	const PartialCurve& first = shards.front();
+	std::vector<bool> seen(first.num_shards, false);
+	for(const auto& shard : shards) {
+		if(shard.num_shards != first.num_shards ||
+		   shard.content_hash != first.content_hash ||
+		   shard.max_k != first.max_k ||
+		   shard.num_genes != first.num_genes) {
+			throw std::runtime_error(
+			    "The shards were computed for different inputs or "
+			    "partitions.");
+		}
+
+		if(seen[shard.shard]) {
+			throw std::runtime_error("Shard " + std::to_string(shard.shard) +
+			                         " was given twice.");
+		}
+		seen[shard.shard] = true;
+	}
+
+	for(std::size_t i = 0; i < seen.size(); ++i) {
+		if(!seen[i]) {
+			throw std::runtime_error("Shard " + std::to_string(i) + " of " +
+			                         std::to_string(seen.size()) +
+			                         " is missing.");
+		}
+	}
+
+	// Points a shard did not report keep the trivial bounds
+	lower.assign(first.max_k + 1, 0);
+	upper.assign(first.max_k + 1, first.num_genes);
+	upper[0] = 0;
+	for(const auto& shard : shards) {
+		for(const auto& p : shard.points) {
+			lower[p.k] = std::max(lower[p.k], p.lower);
+			upper[p.k] = std::min(upper[p.k], p.upper);
+		}
+	}
+
+	for(std::size_t k = 1; k < lower.size(); ++k) {
+		lower[k] = std::max(lower[k], lower[k - 1]);
+	}
+
+	for(std::size_t k = upper.size() - 1; k-- > 0;) {
+		upper[k] = std::min(upper[k], upper[k + 1]);
+	}
+
+	for(std::size_t k = 0; k < lower.size(); ++k) {
+		if(lower[k] > upper[k]) {
+			throw std::runtime_error(
+			    "The shards contradict each other at k = " +
+			    std::to_string(k) + ": " + std::to_string(lower[k]) +
+			    " genes covered, but at most " + std::to_string(upper[k]) +
+			    " possible.");
+		}
+	}
+}
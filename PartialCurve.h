@@ -0,0 +1,74 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MINMAX_PARTIALCURVE_H
+#define MINMAX_PARTIALCURVE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * The points of a maxgene curve computed by one of several independent
+ * processes, e.g. jobs on a cluster sharing a file system. Shard i of N is
+ * assigned every k with k % N == i between 1 and max_k. Every point
+ * carries bounds on the optimal number of covered genes, which coincide
+ * for solved points. Stored as tab-separated text:
+ *
+ *   maxgene-curve-shard <shard> <num_shards> <hash> <max_k> <num_genes>
+ *   <k> <lower> <upper> <status>
+ *   ...
+ *
+ * The hash is the content hash of the mappings, such that shards of
+ * different inputs are not merged by accident.
+ */
+struct PartialCurve
+{
+	struct Point
+	{
+		std::size_t k;
+		std::size_t lower;
+		std::size_t upper;
+		std::string status;
+	};
+
+	std::size_t shard = 0;
+	std::size_t num_shards = 1;
+	std::uint64_t content_hash = 0;
+	std::size_t max_k = 0;
+	std::size_t num_genes = 0;
+	std::vector<Point> points;
+};
+
+/// Throws std::runtime_error if the file cannot be written.
+void writePartialCurve(const std::string& path, const PartialCurve& curve);
+
+/// Throws std::runtime_error if the file cannot be read or is malformed.
+PartialCurve readPartialCurve(const std::string& path);
+
+/**
+ * Merges the shards of one curve into bounds for every k between 0 and
+ * max_k. Coverage does not decrease in k, hence lower bounds propagate to
+ * larger k and upper bounds to smaller k. Throws std::runtime_error if the
+ * shards belong to different inputs or partitions, if a shard is missing
+ * or duplicated, or if the bounds contradict each other.
+ */
+void mergePartialCurves(const std::vector<PartialCurve>& shards,
+                        std::vector<std::size_t>& lower,
+                        std::vector<std::size_t>& upper);
+
+#endif // MINMAX_PARTIALCURVE_H
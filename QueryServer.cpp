@@ -0,0 +1,555 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "QueryServer.h"
+
+#include "BatchSolver.h"
+#include "Json.h"
+#include "MaxGeneCurve.h"
+#include "MaxGeneProblem.h"
+#include "MinMaxProblem.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+bool writeAll(int fd, const char* data, std::size_t size)
+{
+	while(size > 0) {
+		const ssize_t n = write(fd, data, size);
+		if(n < 0 && errno == EINTR) {
+			continue;
+		}
+
+		if(n <= 0) {
+			return false;
+		}
+
+		data += n;
+		size -= n;
+	}
+
+	return true;
+}
+
+// Output side of a stream, tracks the requests that are still running
+class Connection
+{
+  public:
+	explicit Connection(int fd) : fd_(fd), pending_(0) {}
+
+	void begin()
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		++pending_;
+	}
+
+	void finish(const std::string& response)
+	{
+		const std::string line = response + '\n';
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		// A closed connection only loses its remaining responses
+		writeAll(fd_, line.data(), line.size());
+		--pending_;
+		cond_.notify_all();
+	}
+
+	void wait()
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		cond_.wait(lock, [this]() { return pending_ == 0; });
+	}
+
+  private:
+	int fd_;
+	std::size_t pending_;
+	std::mutex mutex_;
+	std::condition_variable cond_;
+};
+
+const JsonValue& member(const JsonValue& request, const char* key)
+{
+	const JsonValue* value = request.find(key);
+	if(!value) {
+		throw std::runtime_error(std::string("Missing field '") + key + "'.");
+	}
+
+	return *value;
+}
+
+std::size_t count(const JsonValue& request, const char* key)
+{
+	const double value = member(request, key).asNumber();
+	if(value < 0 || value != static_cast<std::size_t>(value)) {
+		throw std::runtime_error(std::string("Field '") + key +
+		                         "' needs to be a non-negative integer.");
+	}
+
+	return static_cast<std::size_t>(value);
+}
+
+void writeId(std::ostream& out, const JsonValue* id)
+{
+	if(id && id->type() == JsonValue::Type::Number) {
+		out << id->asNumber();
+	} else if(id && id->type() == JsonValue::Type::String) {
+		writeJsonString(out, id->asString());
+	} else {
+		out << "null";
+	}
+}
+
+void writeNames(std::ostream& out, const TargetMappings& mappings,
+                const std::vector<std::size_t>& ids, bool mirnas)
+{
+	out << '[';
+	for(size_t i = 0; i < ids.size(); ++i) {
+		out << (i > 0 ? "," : "");
+		writeJsonString(out, mirnas ? mappings.mirna(ids[i])
+		                            : mappings.gene(ids[i]));
+	}
+	out << ']';
+}
+
+// Gene set of a request that restricts the genes
+GeneSet requestedGenes(const JsonValue& genes, const TargetMappings& mappings,
+                       std::size_t& num_unknown)
+{
+	GeneSet set;
+	num_unknown = 0;
+
+	for(const auto& gene : genes.asArray()) {
+		const std::size_t id = mappings.geneNames().find(gene.asString());
+		if(id == NameTable::npos) {
+			++num_unknown;
+		} else {
+			set.genes.push_back(id);
+		}
+	}
+
+	std::sort(set.genes.begin(), set.genes.end());
+	set.genes.erase(std::unique(set.genes.begin(), set.genes.end()),
+	                set.genes.end());
+
+	return set;
+}
+
+// Refers to lvalue mappings and takes over rvalue ones
+template <typename Mappings>
+std::unique_ptr<ILPProblem> createProblem(const JsonValue& request,
+                                          const std::string& command,
+                                          Mappings&& mappings)
+{
+	if(command == "maxgene") {
+		return std::unique_ptr<ILPProblem>(
+		    new MaxGeneProblem(std::forward<Mappings>(mappings),
+		                       count(request, "num_mirna")));
+	}
+
+	return std::unique_ptr<ILPProblem>(
+	    new MinMaxProblem(std::forward<Mappings>(mappings),
+	                      member(request, "mirna_weight").asNumber(),
+	                      member(request, "gene_weight").asNumber()));
+}
+
+// Solves a problem on all genes without copying the mappings
+BatchSolver::Result solveAll(const JsonValue& request,
+                             const std::string& command,
+                             const TargetMappings& mappings, int threads,
+                             const SolveLimits& limits,
+                             const ResultCache* cache, const std::string& key)
+{
+	BatchSolver::Result result;
+	const std::uint64_t hash = cache ? mappings.contentHash() : 0;
+
+	ResultCache::Entry entry;
+	if(cache && cache->load(hash, key, entry)) {
+		result.objective = entry.objective;
+		result.mirnas = std::move(entry.mirnas);
+	} else {
+		auto problem = createProblem(request, command, mappings);
+		problem->setNumThreads(threads);
+		problem->setLimits(limits);
+		problem->solve();
+
+		result.objective = problem->objectiveValue();
+		result.mirnas = problem->selectedMirnas();
+		if(cache && ResultCache::cacheable(problem->solveStats())) {
+			entry.objective = result.objective;
+			entry.mirnas = result.mirnas;
+			cache->store(hash, key, entry);
+		}
+	}
+
+	std::vector<bool> covered(mappings.numGenes(), false);
+	const auto& offsets = mappings.mirnaOffsets();
+	const auto& targets = mappings.mirnaGenes();
+	for(std::size_t m : result.mirnas) {
+		for(auto i = offsets[m]; i < offsets[m + 1]; ++i) {
+			if(!covered[targets[i]]) {
+				covered[targets[i]] = true;
+				result.genes.push_back(targets[i]);
+			}
+		}
+	}
+
+	std::sort(result.genes.begin(), result.genes.end());
+
+	return result;
+}
+
+void answer(const JsonValue& request, const TargetMappings& mappings,
+            int threads, const SolveLimits& limits, const ResultCache* cache,
+            std::ostream& out)
+{
+	const std::string& command = member(request, "command").asString();
+
+	// Unrestricted queries use the loaded mappings as they are
+	const JsonValue* genes = request.find("genes");
+	std::size_t num_unknown = 0;
+	const GeneSet set =
+	    genes ? requestedGenes(*genes, mappings, num_unknown) : GeneSet();
+	out << ",\"unknown_genes\":" << num_unknown;
+
+	if(command == "curve") {
+		TargetMappings restricted;
+		if(genes) {
+			restricted = mappings.restrictToGenes(set.genes);
+		}
+
+		MaxGeneCurve curve(genes ? restricted : mappings);
+		curve.setVerbose(false);
+		curve.setNumThreads(threads);
+		curve.setSolveLimits({0.0, limits.gap});
+		curve.setTimeLimit(limits.time);
+		curve.setCache(cache);
+		if(request.find("max_mirna")) {
+			curve.setMaxMirnas(count(request, "max_mirna"));
+		}
+
+		const auto genes = curve.compute();
+		out << ",\"curve\":[";
+		for(size_t i = 0; i < genes.size(); ++i) {
+			out << (i > 0 ? "," : "") << genes[i];
+		}
+		out << ']';
+		return;
+	}
+
+	std::string key;
+	if(command == "maxgene") {
+		const std::size_t k = count(request, "num_mirna");
+		key = ResultCache::problemKey("maxgene", {double(k)});
+	} else if(command == "minmax") {
+		const double mirna_weight = member(request, "mirna_weight").asNumber();
+		const double gene_weight = member(request, "gene_weight").asNumber();
+		key = ResultCache::problemKey("minmax", {mirna_weight, gene_weight});
+	} else {
+		throw std::runtime_error("Unknown command '" + command + "'.");
+	}
+
+	BatchSolver::Result result;
+	if(genes) {
+		auto factory = [&](TargetMappings&& m) {
+			auto problem = createProblem(request, command, std::move(m));
+			problem->setLimits(limits);
+			return problem;
+		};
+
+		BatchSolver solver(mappings, factory);
+		solver.setCache(cache, key);
+		result = solver.solve(set, threads);
+	} else {
+		result = solveAll(request, command, mappings, threads, limits, cache,
+		                  key);
+	}
+
+	out << ",\"objective\":" << result.objective << ",\"mirnas\":";
+	writeNames(out, mappings, result.mirnas, true);
+	out << ",\"genes\":";
+	writeNames(out, mappings, result.genes, false);
+}
+}
+
+QueryServer::QueryServer() : jobs_(1), cache_(nullptr), stop_(false) {}
+
+QueryServer::~QueryServer()
+{
+	// Clients submit to the workers, they have to finish first
+	stopClients_();
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+
+	cond_.notify_all();
+	for(auto& w : workers_) {
+		w.join();
+	}
+}
+
+void QueryServer::addMappings(const std::string& name,
+                              const TargetMappings& mappings)
+{
+	// Computed once here, workers only read the memoized hash
+	mappings.contentHash();
+	tables_.emplace_back(name, &mappings);
+}
+
+void QueryServer::setNumJobs(std::size_t jobs)
+{
+	jobs_ = std::max<std::size_t>(jobs, 1);
+}
+
+void QueryServer::setLimits(const SolveLimits& limits) { limits_ = limits; }
+
+void QueryServer::setCache(const ResultCache* cache) { cache_ = cache; }
+
+std::string QueryServer::handle(const std::string& line) const
+{
+	std::ostringstream out;
+	out.precision(15);
+
+	JsonValue request;
+	try {
+		request = JsonValue::parse(line);
+	} catch(const std::exception& e) {
+		out << "{\"id\":null,\"status\":\"error\",\"message\":";
+		writeJsonString(out, e.what());
+		out << '}';
+		return out.str();
+	}
+
+	out << "{\"id\":";
+	writeId(out, request.find("id"));
+
+	try {
+		const TargetMappings* mappings = nullptr;
+		if(const JsonValue* name = request.find("mappings")) {
+			for(const auto& table : tables_) {
+				if(table.first == name->asString()) {
+					mappings = table.second;
+				}
+			}
+		} else if(!tables_.empty()) {
+			mappings = tables_.front().second;
+		}
+
+		if(!mappings) {
+			throw std::runtime_error("Unknown mappings.");
+		}
+
+		std::ostringstream body;
+		body.precision(15);
+		answer(request, *mappings, ILPProblem::threadsPerJob(jobs_), limits_,
+		       cache_, body);
+		out << ",\"status\":\"ok\"" << body.str() << '}';
+	} catch(const std::exception& e) {
+		out << ",\"status\":\"error\",\"message\":";
+		writeJsonString(out, e.what());
+		out << '}';
+	}
+
+	return out.str();
+}
+
+void QueryServer::serveStream(int in_fd, int out_fd)
+{
+	auto connection = std::make_shared<Connection>(out_fd);
+	auto dispatch = [this, &connection](std::string line) {
+		if(!line.empty() && line.back() == '\r') {
+			line.pop_back();
+		}
+
+		if(line.find_first_not_of(" \t") == std::string::npos) {
+			return;
+		}
+
+		connection->begin();
+		submit_([this, connection, line]() {
+			connection->finish(handle(line));
+		});
+	};
+
+	std::string buffer;
+	char chunk[1 << 16];
+	while(true) {
+		const ssize_t n = read(in_fd, chunk, sizeof(chunk));
+		if(n < 0 && errno == EINTR) {
+			continue;
+		}
+
+		if(n <= 0) {
+			break;
+		}
+
+		buffer.append(chunk, n);
+
+		std::size_t begin = 0;
+		std::size_t end = buffer.find('\n');
+		while(end != std::string::npos) {
+			dispatch(buffer.substr(begin, end - begin));
+			begin = end + 1;
+			end = buffer.find('\n', begin);
+		}
+
+		buffer.erase(0, begin);
+	}
+
+	dispatch(buffer);
+	connection->wait();
+}
+
+void QueryServer::serveSocket(const std::string& path)
+{
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	if(path.size() >= sizeof(address.sun_path)) {
+		throw std::runtime_error("Socket path '" + path + "' is too long.");
+	}
+
+	std::strcpy(address.sun_path, path.c_str());
+
+	const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(fd < 0) {
+		throw std::runtime_error("Could not create a socket.");
+	}
+
+	unlink(path.c_str());
+	if(bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+	   listen(fd, 64) != 0) {
+		close(fd);
+		throw std::runtime_error("Could not listen on '" + path + "'.");
+	}
+
+	// Clients closing early must not terminate the server
+	std::signal(SIGPIPE, SIG_IGN);
+
+	while(true) {
+		const int client = accept(fd, nullptr, nullptr);
+		if(client < 0) {
+			if(errno == EINTR || errno == ECONNABORTED) {
+				continue;
+			}
+
+			close(fd);
+			stopClients_();
+			throw std::runtime_error("Could not accept connections on '" +
+			                         path + "'.");
+		}
+
+		reapClients_();
+
+		std::lock_guard<std::mutex> lock(clients_mutex_);
+		clients_.push_back(Client{std::thread(), client, false});
+		Client& entry = clients_.back();
+		entry.thread = std::thread([this, &entry]() {
+			serveStream(entry.fd, entry.fd);
+
+			std::lock_guard<std::mutex> lock(clients_mutex_);
+			close(entry.fd);
+			entry.done = true;
+		});
+	}
+}
+
+void QueryServer::reapClients_()
+{
+	std::list<Client> finished;
+	{
+		std::lock_guard<std::mutex> lock(clients_mutex_);
+		for(auto it = clients_.begin(); it != clients_.end();) {
+			auto next = std::next(it);
+			if(it->done) {
+				finished.splice(finished.end(), clients_, it);
+			}
+			it = next;
+		}
+	}
+
+	for(auto& c : finished) {
+		c.thread.join();
+	}
+}
+
+void QueryServer::stopClients_()
+{
+	// Open connections read end of input and return after answering the
+	// requests received so far
+	{
+		std::lock_guard<std::mutex> lock(clients_mutex_);
+		for(auto& c : clients_) {
+			if(!c.done) {
+				shutdown(c.fd, SHUT_RDWR);
+			}
+		}
+	}
+
+	for(auto& c : clients_) {
+		c.thread.join();
+	}
+
+	clients_.clear();
+}
+
+void QueryServer::submit_(std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if(workers_.empty()) {
+			for(size_t i = 0; i < jobs_; ++i) {
+				workers_.emplace_back(&QueryServer::work_, this);
+			}
+		}
+
+		tasks_.push_back(std::move(task));
+	}
+
+	cond_.notify_one();
+}
+
+void QueryServer::work_()
+{
+	while(true) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			cond_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+			if(tasks_.empty()) {
+				return;
+			}
+
+			task = std::move(tasks_.front());
+			tasks_.pop_front();
+		}
+
+		task();
+	}
+}
@@ -0,0 +1,104 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef QUERYSERVER_H
+#define QUERYSERVER_H
+
+#include "ILPProblem.h"
+#include "ResultCache.h"
+#include "TargetMappings.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * Answers queries against mappings that stay loaded in memory. Requests
+ * and responses are JSON objects, one per line:
+ *
+ *   {"id": 1, "command": "maxgene", "num_mirna": 5}
+ *   {"id": 2, "command": "minmax", "mirna_weight": 1, "gene_weight": 2}
+ *   {"id": 3, "command": "curve", "max_mirna": 10}
+ *
+ * All commands accept "mappings", the name of the table to use (default:
+ * the first one), and "genes", a list of gene names the query is
+ * restricted to. Responses echo the id and carry "status" ("ok" or
+ * "error" with a "message"). Requests are answered concurrently by a
+ * pool of workers, responses are written as soon as they are available
+ * and thus may arrive out of order.
+ */
+class QueryServer
+{
+  public:
+	QueryServer();
+	~QueryServer();
+
+	/// The mappings need to be finalized and outlive the server.
+	void addMappings(const std::string& name, const TargetMappings& mappings);
+	void setNumJobs(std::size_t jobs);
+	/// Budget of every query, curves spend the time on all their solves.
+	void setLimits(const SolveLimits& limits);
+	/// Reuses and stores optimal results of all queries. The cache needs
+	/// to outlive the server.
+	void setCache(const ResultCache* cache);
+
+	/// Answers requests read from in_fd on out_fd until end of input.
+	void serveStream(int in_fd, int out_fd);
+	/// Listens on a Unix domain socket and serves every connection like a
+	/// stream. Only returns by throwing std::runtime_error, after the
+	/// open connections have been shut down and their threads joined.
+	void serveSocket(const std::string& path);
+
+	/// Returns the response line (without newline) for a request line.
+	std::string handle(const std::string& request) const;
+
+  private:
+	struct Client
+	{
+		std::thread thread;
+		int fd;
+		bool done;
+	};
+
+	std::vector<std::pair<std::string, const TargetMappings*>> tables_;
+	std::size_t jobs_;
+	SolveLimits limits_;
+	const ResultCache* cache_;
+
+	std::mutex mutex_;
+	std::condition_variable cond_;
+	std::deque<std::function<void()>> tasks_;
+	std::vector<std::thread> workers_;
+	bool stop_;
+
+	// Connections of serveSocket(), guarded by clients_mutex_
+	std::mutex clients_mutex_;
+	std::list<Client> clients_;
+
+	void submit_(std::function<void()> task);
+	void work_();
+	void reapClients_();
+	void stopClients_();
+};
+
+#endif // QUERYSERVER_H
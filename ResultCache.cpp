@@ -0,0 +1,231 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ResultCache.h"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+std::string hex(std::uint64_t value)
+{
+	std::ostringstream out;
+	out << std::hex << std::setw(16) << std::setfill('0') << value;
+	return out.str();
+}
+
+std::string fullKey(std::uint64_t content_hash, const std::string& problem)
+{
+	return hex(content_hash) + ' ' + problem;
+}
+
+std::vector<std::size_t> readIds(std::istream& in)
+{
+	std::vector<std::size_t> ids;
+	std::size_t id;
+	while(in >> id) {
+		ids.push_back(id);
+	}
+
+	return ids;
+}
+
+void writeIds(std::ostream& out, const std::vector<std::size_t>& ids)
+{
+	for(std::size_t id : ids) {
+		out << ' ' << id;
+	}
+}
+}
+
+ResultCache::ResultCache(std::string directory)
+    : directory_(std::move(directory))
+{
+	if(mkdir(directory_.c_str(), 0777) != 0 && errno != EEXIST) {
+		throw std::runtime_error("Could not create the cache directory '" +
+		                         directory_ + "'.");
+	}
+}
+
+std::string ResultCache::problemKey(const std::string& name,
+                                   std::initializer_list<double> parameters)
+{
+	std::ostringstream out;
+	out.precision(17);
+	out << name;
+	for(double p : parameters) {
+		out << ' ' << p;
+	}
+
+	return out.str();
+}
+
+bool ResultCache::cacheable(const SolveStats& stats)
+{
+	return stats.optimal && stats.gap >= 0.0 && stats.gap <= 1e-4;
+}
+
+std::string ResultCache::path_(const std::string& key,
+                               const char* extension) const
+{
+	// FNV-1a, the key itself is checked when reading
+	std::uint64_t h = 0xcbf29ce484222325ull;
+	for(unsigned char c : key) {
+		h = (h ^ c) * 0x100000001b3ull;
+	}
+
+	return directory_ + '/' + hex(h) + extension;
+}
+
+bool ResultCache::load(std::uint64_t content_hash, const std::string& problem,
+                       Entry& entry) const
+{
+	const std::string key = fullKey(content_hash, problem);
+	std::ifstream input(path_(key, ".result"));
+
+	std::string line;
+	if(!std::getline(input, line) || line != key) {
+		return false;
+	}
+
+	if(!(input >> entry.objective)) {
+		return false;
+	}
+
+	entry.mirnas = readIds(input);
+
+	return input.eof();
+}
+
+void ResultCache::store(std::uint64_t content_hash, const std::string& problem,
+                        const Entry& entry) const
+{
+	const std::string key = fullKey(content_hash, problem);
+	const std::string path = path_(key, ".result");
+
+	// Concurrent writers of the same entry use distinct temporary files
+	const std::size_t thread =
+	    std::hash<std::thread::id>()(std::this_thread::get_id());
+	const std::string tmp = path + '.' + std::to_string(getpid()) + '.' +
+	                        std::to_string(thread);
+
+	std::ofstream output(tmp);
+	output.precision(17);
+	output << key << '\n' << entry.objective << '\n';
+	writeIds(output, entry.mirnas);
+	output << '\n';
+	output.close();
+
+	if(!output || std::rename(tmp.c_str(), path.c_str()) != 0) {
+		std::remove(tmp.c_str());
+	}
+}
+
+std::vector<ResultCache::CurvePoint>
+ResultCache::loadCurve(std::uint64_t content_hash,
+                       const std::string& problem) const
+{
+	const std::string key = fullKey(content_hash, problem);
+	std::ifstream input(path_(key, ".curve"));
+
+	std::vector<CurvePoint> points;
+	std::string line;
+	if(!std::getline(input, line) || line != key) {
+		return points;
+	}
+
+	// A killed run may have left a truncated last line, which lacks the
+	// terminating "end" marker.
+	while(std::getline(input, line)) {
+		std::istringstream fields(line);
+		std::string tag;
+		CurvePoint point;
+		if(!(fields >> tag >> point.k >> point.value) || tag != "point") {
+			continue;
+		}
+
+		point.mirnas = readIds(fields);
+		fields.clear();
+		if(!(fields >> tag) || tag != "end") {
+			continue;
+		}
+
+		points.push_back(std::move(point));
+	}
+
+	return points;
+}
+
+void ResultCache::appendCurve(std::uint64_t content_hash,
+                              const std::string& problem,
+                              const CurvePoint& point) const
+{
+	const std::string key = fullKey(content_hash, problem);
+	const std::string path = path_(key, ".curve");
+
+	// Shards of one curve may append concurrently from several processes
+	const int fd = open(path.c_str(), O_RDWR | O_APPEND | O_CREAT, 0644);
+	if(fd < 0) {
+		return;
+	}
+
+	if(flock(fd, LOCK_EX) != 0) {
+		close(fd);
+		return;
+	}
+
+	std::ostringstream output;
+	struct stat info;
+	char last = '\n';
+	if(fstat(fd, &info) != 0 || info.st_size == 0) {
+		output << key << '\n';
+	} else if(pread(fd, &last, 1, info.st_size - 1) == 1 && last != '\n') {
+		// Terminate a line truncated by a killed run, it is skipped on
+		// loading
+		output << '\n';
+	}
+
+	output << "point " << point.k << ' ' << point.value;
+	writeIds(output, point.mirnas);
+	output << " end\n";
+
+	const std::string record = output.str();
+	for(std::size_t done = 0; done < record.size();) {
+		const ssize_t written =
+		    write(fd, record.data() + done, record.size() - done);
+		if(written < 0 && errno != EINTR) {
+			break;
+		}
+		done += std::max<ssize_t>(written, 0);
+	}
+
+	flock(fd, LOCK_UN);
+	close(fd);
+}
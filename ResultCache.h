@@ -0,0 +1,88 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MINMAX_RESULTCACHE_H
+#define MINMAX_RESULTCACHE_H
+
+#include "ILPProblem.h"
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+/**
+ * On-disk cache of solutions, keyed by the content hash of the finalized
+ * mappings and a description of the problem and its parameters, see
+ * problemKey(). Every key is stored in a file named after the hash of
+ * the key, whose first line repeats the key to rule out collisions:
+ *
+ *   <dir>/<hash>.result  objective and selected miRNA ids
+ *   <dir>/<hash>.curve   one line "k value ids..." per checkpointed point
+ *
+ * Results are written to a temporary file and renamed, curve points are
+ * appended, so killed runs leave no partial entries behind. miRNA ids are
+ * those of the hashed mappings. Failing to write the cache is not an
+ * error, the affected results are simply recomputed next time.
+ */
+class ResultCache
+{
+  public:
+	struct Entry
+	{
+		double objective = 0.0;
+		std::vector<std::size_t> mirnas;
+	};
+
+	struct CurvePoint
+	{
+		std::size_t k = 0;
+		std::size_t value = 0;
+		std::vector<std::size_t> mirnas;
+	};
+
+	/// Creates the directory if it does not exist yet. Throws
+	/// std::runtime_error if that fails.
+	explicit ResultCache(std::string directory);
+
+	/// Problem name followed by its parameters, printed exactly.
+	static std::string problemKey(const std::string& name,
+	                              std::initializer_list<double> parameters);
+	/// Only solutions optimal within the default CPLEX gap are cached, such
+	/// that the limits of one run do not leak into later ones.
+	static bool cacheable(const SolveStats& stats);
+
+	bool load(std::uint64_t content_hash, const std::string& problem,
+	          Entry& entry) const;
+	void store(std::uint64_t content_hash, const std::string& problem,
+	           const Entry& entry) const;
+
+	/// Checkpointed points of a curve in the order they were appended.
+	std::vector<CurvePoint> loadCurve(std::uint64_t content_hash,
+	                                  const std::string& problem) const;
+	/// Appends under an exclusive lock, such that processes computing
+	/// shards of the same curve can share the file.
+	void appendCurve(std::uint64_t content_hash, const std::string& problem,
+	                 const CurvePoint& point) const;
+
+  private:
+	std::string directory_;
+
+	std::string path_(const std::string& key, const char* extension) const;
+};
+
+#endif // MINMAX_RESULTCACHE_H
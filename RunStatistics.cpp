@@ -0,0 +1,95 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "RunStatistics.h"
+
+#include "Json.h"
+
+void RunStatistics::addPhase(const PhaseTime& phase)
+{
+	phases_.push_back(phase);
+}
+
+void RunStatistics::addPhases(const std::vector<PhaseTime>& phases)
+{
+	phases_.insert(phases_.end(), phases.begin(), phases.end());
+}
+
+void RunStatistics::addSolve(const SolveStats& solve)
+{
+	solves_.push_back(solve);
+}
+
+void RunStatistics::addSolves(const std::vector<SolveStats>& solves)
+{
+	solves_.insert(solves_.end(), solves.begin(), solves.end());
+}
+
+void RunStatistics::writeJson(std::ostream& out) const
+{
+	const auto precision = out.precision(6);
+
+	out << "{\"phases\": [";
+	for(size_t i = 0; i < phases_.size(); ++i) {
+		const PhaseTime& p = phases_[i];
+		out << (i > 0 ? "," : "") << "\n  {\"phase\": ";
+		writeJsonString(out, p.phase);
+		out << ", \"wall\": " << p.wall << ", \"cpu\": " << p.cpu
+		    << ", \"peak_rss_kb\": " << p.peak_rss << '}';
+	}
+
+	out << "],\n \"solves\": [";
+	for(size_t i = 0; i < solves_.size(); ++i) {
+		const SolveStats& s = solves_[i];
+		out << (i > 0 ? "," : "") << "\n  {";
+		if(!s.label.empty()) {
+			out << "\"label\": ";
+			writeJsonString(out, s.label);
+			out << ", ";
+		}
+
+		if(s.k >= 0) {
+			out << "\"k\": " << s.k << ", ";
+		}
+
+		out << "\"status\": ";
+		writeJsonString(out, s.status);
+		out << ", \"optimal\": " << (s.optimal ? "true" : "false")
+		    << ", \"wall\": " << s.wall << ", \"cpu\": " << s.cpu
+		    << ", \"peak_rss_kb\": " << s.peak_rss << ", \"nodes\": " << s.nodes
+		    << ", \"gap\": ";
+
+		if(s.gap >= 0.0) {
+			out << s.gap << ", \"objective\": " << s.objective
+			    << ", \"bound\": " << s.bound;
+		} else {
+			out << "null, \"objective\": null, \"bound\": null";
+		}
+
+		out << ", \"first_incumbent\": ";
+		if(s.first_incumbent >= 0.0) {
+			out << s.first_incumbent;
+		} else {
+			out << "null";
+		}
+
+		out << '}';
+	}
+
+	out << "]}\n";
+	out.precision(precision);
+}
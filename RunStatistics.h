@@ -0,0 +1,56 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MINMAX_RUNSTATISTICS_H
+#define MINMAX_RUNSTATISTICS_H
+
+#include "ILPProblem.h"
+#include "Stopwatch.h"
+
+#include <ostream>
+#include <vector>
+
+/**
+ * Collects the timings of the phases of a run and the statistics of all
+ * its solves, written as a single JSON document:
+ *
+ *   {"phases": [{"phase", "wall", "cpu", "peak_rss_kb"}, ...],
+ *    "solves": [{"label", "k", "status", "optimal", "wall", "cpu",
+ *                "peak_rss_kb", "nodes", "gap", "objective", "bound",
+ *                "first_incumbent"}, ...]}
+ *
+ * Times are in seconds. label and k are only present if set. optimal
+ * tells whether the solve was proven optimal within its gap limit, bound
+ * is the best bound on the objective. gap, objective, bound and
+ * first_incumbent are null if there was no solution.
+ */
+class RunStatistics
+{
+  public:
+	void addPhase(const PhaseTime& phase);
+	void addPhases(const std::vector<PhaseTime>& phases);
+	void addSolve(const SolveStats& solve);
+	void addSolves(const std::vector<SolveStats>& solves);
+
+	void writeJson(std::ostream& out) const;
+
+  private:
+	std::vector<PhaseTime> phases_;
+	std::vector<SolveStats> solves_;
+};
+
+#endif // MINMAX_RUNSTATISTICS_H
@@ -0,0 +1,81 @@
+/*
+ * MinMaxMirnaGene - A program for computing optimal miRNA-gene covers.
+ * Copyright (C) 2016 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
+ *
+ * MinMaxMirnaGene is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MinMaxMirnaGene is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MINMAX_STOPWATCH_H
+#define MINMAX_STOPWATCH_H
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <ctime>
+#include <string>
+
+/// Wall clock and CPU seconds spent in a named phase and the peak resident
+/// set size of the process at its end, in kilobytes.
+struct PhaseTime
+{
+	std::string phase;
+	double wall;
+	double cpu;
+	long peak_rss;
+};
+
+/// Peak resident set size of the process so far, in kilobytes.
+inline long peakRss()
+{
+	rusage usage;
+	return getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : 0;
+}
+
+/**
+ * Measures wall clock time and the CPU time of the whole process, i.e.
+ * summed over all threads, since construction or the last reset().
+ */
+class Stopwatch
+{
+  public:
+	Stopwatch() { reset(); }
+
+	void reset()
+	{
+		wall_ = std::chrono::steady_clock::now();
+		cpu_ = std::clock();
+	}
+
+	double wall() const
+	{
+		return std::chrono::duration<double>(
+		           std::chrono::steady_clock::now() - wall_)
+		    .count();
+	}
+
+	double cpu() const
+	{
+		return static_cast<double>(std::clock() - cpu_) / CLOCKS_PER_SEC;
+	}
+
+	PhaseTime phase(const std::string& name) const
+	{
+		return PhaseTime{name, wall(), cpu(), peakRss()};
+	}
+
+  private:
+	std::chrono::steady_clock::time_point wall_;
+	std::clock_t cpu_;
+};
+
+#endif // MINMAX_STOPWATCH_H
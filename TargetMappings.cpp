@@ -18,47 +18,327 @@
 #include "TargetMappings.h"
 
 #include <algorithm>
+#include <numeric>
+#include <thread>
 
-void TargetMappings::add(const std::string& mirna, const std::string& gene)
+void TargetMappings::add(std::string_view mirna, std::string_view gene)
 {
-	size_t m = findOrCreate_(mirna, mirna_to_id_, mirna_names_);
-	size_t g = findOrCreate_(gene, gene_to_id_, gene_names_);
+	add(addMirna(mirna), addGene(gene));
+}
+
+void TargetMappings::add(size_t mirna, size_t gene)
+{
+	pending_.emplace_back(mirna, gene);
+	finalized_ = false;
+	hash_ = 0;
+}
+
+size_t TargetMappings::addMirna(std::string_view mirna)
+{
+	const size_t n = mirnas_.size();
+	const size_t id = mirnas_.insert(mirna);
+
+	if(mirnas_.size() != n) {
+		// The CSR offsets need to cover the new name
+		finalized_ = false;
+		hash_ = 0;
+	}
+
+	return id;
+}
+
+size_t TargetMappings::addGene(std::string_view gene)
+{
+	const size_t n = genes_.size();
+	const size_t id = genes_.insert(gene);
+
+	if(genes_.size() != n) {
+		// The CSR offsets need to cover the new name
+		finalized_ = false;
+		hash_ = 0;
+	}
+
+	return id;
+}
+
+void TargetMappings::reserve(size_t num_mappings)
+{
+	pending_.reserve(num_mappings);
+}
+
+TargetMappings::const_iterator TargetMappings::begin() const
+{
+	const std::size_t num_genes =
+	    gene_offsets_.empty() ? 0 : gene_offsets_.size() - 1;
+
+	return MappingIterator(gene_offsets_.data(), gene_mirnas_.data(),
+	                       num_genes, 0);
+}
+
+TargetMappings::const_iterator TargetMappings::end() const
+{
+	return MappingIterator(gene_offsets_.data(), gene_mirnas_.data(), 0,
+	                       gene_mirnas_.size());
+}
+
+size_t TargetMappings::numMirnas() const { return mirnas_.size(); }
+
+size_t TargetMappings::numGenes() const { return genes_.size(); }
+
+size_t TargetMappings::numMappings() const
+{
+	return gene_mirnas_.size() + pending_.size();
+}
+
+namespace
+{
+// Runs fn(0) ... fn(threads - 1) concurrently
+template <typename Func> void parallelFor(std::size_t threads, Func fn)
+{
+	std::vector<std::thread> workers;
+	for(size_t t = 1; t < threads; ++t) {
+		workers.emplace_back(fn, t);
+	}
+
+	fn(0);
+
+	for(auto& w : workers) {
+		w.join();
+	}
+}
+
+/**
+ * Stable LSD radix sort of the lower bits of keys. Every pass counts the
+ * digits of one block per thread and scatters each block to its own
+ * slice of the buckets, passes in which all keys share a digit are
+ * skipped.
+ */
+void radixSort(std::vector<std::uint64_t>& keys, unsigned bits,
+               std::size_t threads)
+{
+	const unsigned digit_bits = 11;
+	const std::size_t radix = std::size_t(1) << digit_bits;
+	const std::size_t n = keys.size();
+
+	// Tiny blocks are not worth a thread
+	threads = std::max<std::size_t>(1, std::min(threads, n >> 16));
+
+	std::vector<std::uint64_t> buffer(n);
+	std::vector<std::vector<std::size_t>> counts(
+	    threads, std::vector<std::size_t>(radix));
+
+	auto block = [n, threads](std::size_t t) { return t * n / threads; };
+
+	for(unsigned shift = 0; shift < bits; shift += digit_bits) {
+		const std::uint64_t* in = keys.data();
+		std::uint64_t* out = buffer.data();
+
+		parallelFor(threads, [&](std::size_t t) {
+			auto& count = counts[t];
+			std::fill(count.begin(), count.end(), 0);
+			for(size_t i = block(t); i < block(t + 1); ++i) {
+				++count[(in[i] >> shift) & (radix - 1)];
+			}
+		});
+
+		// Turn the counts into the start of every (digit, block) slice
+		std::size_t sum = 0;
+		bool trivial = false;
+		for(size_t d = 0; d < radix; ++d) {
+			const std::size_t start = sum;
+			for(size_t t = 0; t < threads; ++t) {
+				const std::size_t c = counts[t][d];
+				counts[t][d] = sum;
+				sum += c;
+			}
+
+			trivial = trivial || sum - start == n;
+		}
 
-	mappings_.emplace_back(m, g);
+		if(trivial) {
+			continue;
+		}
+
+		parallelFor(threads, [&](std::size_t t) {
+			auto& pos = counts[t];
+			for(size_t i = block(t); i < block(t + 1); ++i) {
+				out[pos[(in[i] >> shift) & (radix - 1)]++] = in[i];
+			}
+		});
+
+		keys.swap(buffer);
+	}
 }
 
-size_t TargetMappings::numMirnas() const { return mirna_names_.size(); }
+unsigned bitWidth(std::uint64_t n)
+{
+	unsigned result = 0;
+	while(n > 0) {
+		++result;
+		n >>= 1;
+	}
+
+	return result;
+}
+}
+
+std::size_t TargetMappings::finalize(std::size_t threads)
+{
+	if(finalized_) {
+		return 0;
+	}
+
+	// Pack (gene, miRNA) into a single key that sorts gene-major. Only
+	// as many bits as the ids need are used, which saves radix passes.
+	const unsigned mirna_bits = bitWidth(numMirnas());
+	const unsigned key_bits = mirna_bits + bitWidth(numGenes());
+	const std::uint64_t mirna_mask = (std::uint64_t(1) << mirna_bits) - 1;
+
+	std::vector<std::uint64_t> keys;
+	keys.reserve(numMappings());
+	for(const auto& mapping : *this) {
+		keys.push_back(std::uint64_t(mapping.gene()) << mirna_bits |
+		               mapping.mirna());
+	}
+
+	for(const auto& mapping : pending_) {
+		keys.push_back(std::uint64_t(mapping.gene()) << mirna_bits |
+		               mapping.mirna());
+	}
+
+	pending_ = std::vector<TargetMapping>();
+
+	radixSort(keys, key_bits, threads);
+
+	const std::size_t num_keys = keys.size();
+	keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+	// Counting sort into both CSR directions. As the keys are sorted by
+	// gene, the genes of every miRNA end up sorted as well.
+	std::vector<std::uint64_t> gene_offsets(numGenes() + 1, 0);
+	std::vector<std::uint64_t> mirna_offsets(numMirnas() + 1, 0);
+	for(std::uint64_t key : keys) {
+		++gene_offsets[(key >> mirna_bits) + 1];
+		++mirna_offsets[(key & mirna_mask) + 1];
+	}
+
+	std::partial_sum(gene_offsets.begin(), gene_offsets.end(),
+	                 gene_offsets.begin());
+	std::partial_sum(mirna_offsets.begin(), mirna_offsets.end(),
+	                 mirna_offsets.begin());
+
+	std::vector<std::uint32_t> gene_mirnas(keys.size());
+	std::vector<std::uint32_t> mirna_genes(keys.size());
+	std::vector<std::uint64_t> pos(mirna_offsets.begin(),
+	                               mirna_offsets.end() - 1);
+	for(size_t i = 0; i < keys.size(); ++i) {
+		const std::uint32_t mirna = keys[i] & mirna_mask;
+		gene_mirnas[i] = mirna;
+		mirna_genes[pos[mirna]++] = keys[i] >> mirna_bits;
+	}
+
+	gene_offsets_ = std::move(gene_offsets);
+	gene_mirnas_ = std::move(gene_mirnas);
+	mirna_offsets_ = std::move(mirna_offsets);
+	mirna_genes_ = std::move(mirna_genes);
 
-size_t TargetMappings::numGenes() const { return gene_names_.size(); }
+	finalized_ = true;
 
-size_t TargetMappings::numMappings() const { return mappings_.size(); }
+	return num_keys - keys.size();
+}
 
-void TargetMappings::finalize()
+TargetMappings
+TargetMappings::restrictToGenes(const std::vector<std::size_t>& genes) const
 {
-	auto comp = [](const TargetMapping& a, const TargetMapping& b) {
-		if(a.gene() == b.gene()) {
-			return a.mirna() < b.mirna();
+	TargetMappings result;
+	result.mirnas_ = mirnas_;
+	result.genes_ = genes_;
+
+	std::vector<bool> selected(numGenes(), false);
+	for(std::size_t g : genes) {
+		selected[g] = true;
+	}
+
+	std::vector<std::uint64_t> gene_offsets(numGenes() + 1, 0);
+	std::vector<std::uint32_t> gene_mirnas;
+	std::vector<std::uint64_t> mirna_offsets(numMirnas() + 1, 0);
+	for(size_t g = 0; g < numGenes(); ++g) {
+		if(selected[g]) {
+			for(auto i = gene_offsets_[g]; i < gene_offsets_[g + 1]; ++i) {
+				gene_mirnas.push_back(gene_mirnas_[i]);
+				++mirna_offsets[gene_mirnas_[i] + 1];
+			}
 		}
 
-		return a.gene() < b.gene();
-	};
+		gene_offsets[g + 1] = gene_mirnas.size();
+	}
 
-	std::sort(mappings_.begin(), mappings_.end(), comp);
-	auto new_end = std::unique(mappings_.begin(), mappings_.end());
+	std::partial_sum(mirna_offsets.begin(), mirna_offsets.end(),
+	                 mirna_offsets.begin());
 
-	mappings_.erase(new_end, mappings_.end());
+	std::vector<std::uint32_t> mirna_genes(gene_mirnas.size());
+	std::vector<std::uint64_t> pos(mirna_offsets.begin(),
+	                               mirna_offsets.end() - 1);
+	for(size_t g = 0; g < numGenes(); ++g) {
+		for(auto i = gene_offsets[g]; i < gene_offsets[g + 1]; ++i) {
+			mirna_genes[pos[gene_mirnas[i]]++] = g;
+		}
+	}
+
+	result.gene_offsets_ = std::move(gene_offsets);
+	result.gene_mirnas_ = std::move(gene_mirnas);
+	result.mirna_offsets_ = std::move(mirna_offsets);
+	result.mirna_genes_ = std::move(mirna_genes);
+	result.finalized_ = true;
+
+	return result;
 }
 
-size_t TargetMappings::findOrCreate_(const std::string& s,
-                                     std::unordered_map<std::string, int>& m,
-                                     std::vector<std::string>& v) const
+namespace
 {
-	auto res = m.find(s);
+std::uint64_t hashBytes(std::uint64_t h, const void* data, std::size_t size)
+{
+	const auto* p = static_cast<const unsigned char*>(data);
+	for(std::size_t i = 0; i < size; ++i) {
+		h = (h ^ p[i]) * 0x100000001b3ull;
+	}
 
-	if(res == m.end()) {
-		res = m.emplace(s, v.size()).first;
-		v.push_back(s);
+	return h;
+}
+
+std::uint64_t hashNames(std::uint64_t h, const NameTable& names)
+{
+	const std::uint64_t n = names.size();
+	h = hashBytes(h, &n, sizeof(n));
+	for(std::size_t i = 0; i < names.size(); ++i) {
+		const std::uint64_t len = names[i].size();
+		h = hashBytes(h, &len, sizeof(len));
+		h = hashBytes(h, names[i].data(), names[i].size());
+	}
+
+	return h;
+}
+}
+
+std::uint64_t TargetMappings::contentHash() const
+{
+	if(hash_ != 0) {
+		return hash_;
+	}
+
+	// FNV-1a over the names and the mappings as 32 bit pairs
+	std::uint64_t h = 0xcbf29ce484222325ull;
+	h = hashNames(h, mirnas_);
+	h = hashNames(h, genes_);
+
+	for(const auto& mapping : *this) {
+		const std::uint32_t pair[2] = {
+		    static_cast<std::uint32_t>(mapping.mirna()),
+		    static_cast<std::uint32_t>(mapping.gene())};
+		h = hashBytes(h, pair, sizeof(pair));
 	}
 
-	return res->second;
+	hash_ = h;
+
+	return hash_;
 }
@@ -18,67 +18,175 @@
 #ifndef MINMAX_TARGET_MAPPINGS_H
 #define MINMAX_TARGET_MAPPINGS_H
 
+#include "Buffer.h"
+#include "NameTable.h"
+
+#include <cstdint>
+#include <iterator>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <vector>
 
 class TargetMapping
 {
   public:
-	TargetMapping(size_t m, size_t g) : mirna_(m), gene_(g) {}
+	TargetMapping(std::size_t m, std::size_t g) : mirna_(m), gene_(g) {}
 
-	size_t mirna() const { return mirna_; }
+	std::size_t mirna() const { return mirna_; }
 
-	size_t gene() const { return gene_; }
+	std::size_t gene() const { return gene_; }
 
-	bool operator==(const TargetMapping& t)
+	bool operator==(const TargetMapping& t) const
 	{
 		return mirna_ == t.mirna_ && gene_ == t.gene_;
 	}
 
   private:
-	size_t mirna_;
-	size_t gene_;
+	std::uint32_t mirna_;
+	std::uint32_t gene_;
 };
 
+/**
+ * Iterates the mappings stored in a gene-major CSR matrix, i.e. the
+ * regulators of gene g are mirnas[offsets[g]] ... mirnas[offsets[g + 1]].
+ */
+class MappingIterator
+{
+  public:
+	using iterator_category = std::forward_iterator_tag;
+	using value_type = TargetMapping;
+	using difference_type = std::ptrdiff_t;
+	using pointer = void;
+	using reference = TargetMapping;
+
+	MappingIterator(const std::uint64_t* offsets, const std::uint32_t* mirnas,
+	                std::size_t num_genes, std::size_t pos)
+	    : offsets_(offsets),
+	      mirnas_(mirnas),
+	      num_genes_(num_genes),
+	      gene_(0),
+	      pos_(pos)
+	{
+		skipEmpty_();
+	}
+
+	TargetMapping operator*() const
+	{
+		return TargetMapping(mirnas_[pos_], gene_);
+	}
+
+	MappingIterator& operator++()
+	{
+		++pos_;
+		skipEmpty_();
+		return *this;
+	}
+
+	MappingIterator operator++(int)
+	{
+		MappingIterator tmp(*this);
+		++*this;
+		return tmp;
+	}
+
+	bool operator==(const MappingIterator& o) const { return pos_ == o.pos_; }
+	bool operator!=(const MappingIterator& o) const { return pos_ != o.pos_; }
+
+  private:
+	const std::uint64_t* offsets_;
+	const std::uint32_t* mirnas_;
+	std::size_t num_genes_;
+	std::size_t gene_;
+	std::size_t pos_;
+
+	void skipEmpty_()
+	{
+		while(gene_ < num_genes_ && pos_ >= offsets_[gene_ + 1]) {
+			++gene_;
+		}
+	}
+};
+
+/**
+ * miRNA - gene mappings with 32 bit ids. Names are interned in one string
+ * arena per kind. After finalize(), the mappings are available as CSR
+ * adjacency in both directions:
+ *
+ *   gene -> miRNAs: geneMirnas()[geneOffsets()[g] ... geneOffsets()[g + 1]]
+ *   miRNA -> genes: mirnaGenes()[mirnaOffsets()[m] ... mirnaOffsets()[m + 1]]
+ *
+ * Both adjacency lists are sorted. Iteration yields the mappings sorted by
+ * gene and requires the mappings to be finalized.
+ */
 class TargetMappings
 {
   public:
-	using iterator = std::vector<TargetMapping>::iterator;
-	using const_iterator = std::vector<TargetMapping>::const_iterator;
+	using const_iterator = MappingIterator;
 
-	void add(const std::string& mirna, const std::string& gene);
+	void add(std::string_view mirna, std::string_view gene);
+	/// Adds a mapping between already known miRNA and gene ids.
+	void add(size_t mirna, size_t gene);
 
-	iterator begin() { return mappings_.begin(); }
-	iterator end() { return mappings_.end(); }
+	/// Returns the id of the given miRNA, registering it if necessary.
+	size_t addMirna(std::string_view mirna);
+	/// Returns the id of the given gene, registering it if necessary.
+	size_t addGene(std::string_view gene);
 
-	const_iterator begin() const { return mappings_.begin(); }
-	const_iterator end() const { return mappings_.end(); }
+	void reserve(size_t num_mappings);
 
-	const_iterator cbegin() const { return mappings_.begin(); }
-	const_iterator cend() { return mappings_.end(); }
+	const_iterator begin() const;
+	const_iterator end() const;
 
 	size_t numGenes() const;
 	size_t numMirnas() const;
 	size_t numMappings() const;
 
-	const std::string& mirna(size_t i) { return mirna_names_[i]; }
-	const std::string& gene(size_t i) { return gene_names_[i]; }
+	std::string_view mirna(size_t i) const { return mirnas_[i]; }
+	std::string_view gene(size_t i) const { return genes_[i]; }
+
+	const NameTable& mirnaNames() const { return mirnas_; }
+	const NameTable& geneNames() const { return genes_; }
+
+	const Buffer<std::uint64_t>& geneOffsets() const { return gene_offsets_; }
+	const Buffer<std::uint32_t>& geneMirnas() const { return gene_mirnas_; }
+	const Buffer<std::uint64_t>& mirnaOffsets() const
+	{
+		return mirna_offsets_;
+	}
+	const Buffer<std::uint32_t>& mirnaGenes() const { return mirna_genes_; }
+
+	/// Sorts the mappings by gene, removes duplicates and builds the CSR
+	/// adjacency using a radix sort on the given number of threads.
+	/// Returns the number of removed duplicates. Does nothing if no
+	/// mappings were added since the last call.
+	std::size_t finalize(std::size_t threads = 1);
+	bool isFinalized() const { return finalized_; }
 
-	void finalize();
+	/// Returns the finalized mappings of the given genes only. All ids are
+	/// kept and the names are shared with this object, genes outside of
+	/// the set have no regulators. The mappings need to be finalized.
+	TargetMappings restrictToGenes(const std::vector<std::size_t>& genes) const;
+
+	/// Hash over the names and mappings, identical for identical inputs.
+	std::uint64_t contentHash() const;
 
   private:
-	std::vector<std::string> gene_names_;
-	std::vector<std::string> mirna_names_;
+	friend void readBinaryMappings(const std::string& path,
+	                               TargetMappings& mappings);
+
+	NameTable mirnas_;
+	NameTable genes_;
 
-	std::unordered_map<std::string, int> gene_to_id_;
-	std::unordered_map<std::string, int> mirna_to_id_;
+	// Mappings added since the last call to finalize()
+	std::vector<TargetMapping> pending_;
 
-	std::vector<TargetMapping> mappings_;
+	Buffer<std::uint64_t> gene_offsets_;
+	Buffer<std::uint32_t> gene_mirnas_;
+	Buffer<std::uint64_t> mirna_offsets_;
+	Buffer<std::uint32_t> mirna_genes_;
 
-	size_t findOrCreate_(const std::string& s,
-	                     std::unordered_map<std::string, int>& m,
-	                     std::vector<std::string>& v) const;
+	bool finalized_ = false;
+	mutable std::uint64_t hash_ = 0;
 };
 
 #endif // MINMAX_TARGET_MAPPINGS_H
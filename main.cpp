@@ -15,32 +15,103 @@
  * You should have received a copy of the GNU General Public License
  * along with MinMaxMirnaGene. If not, see <http://www.gnu.org/licenses/>.
  */
+#include "BatchSolver.h"
+#include "BinaryMappings.h"
 #include "CPLEXException.h"
+#include "ConnectedComponents.h"
+#include "GreedyCover.h"
+#include "LagrangianBound.h"
+#include "MappingsParser.h"
+#include "MaxGeneCurve.h"
 #include "MaxGeneProblem.h"
 #include "MinMaxProblem.h"
+#include "MinMaxSweep.h"
+#include "MinMirnaProblem.h"
+#include "PartialCurve.h"
+#include "QueryServer.h"
+#include "ResultCache.h"
+#include "RunStatistics.h"
+#include "Stopwatch.h"
 #include "TargetMappings.h"
 
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <csignal>
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+// Phases and solves of this run, reported with --stats json
+RunStatistics statistics;
+
+// Optimal results of earlier runs, enabled with --cache dir
+std::unique_ptr<ResultCache> cache;
+
+// Applied while parsing text mappings, set with --genes and --min-score
+MappingsFilter filter;
+
+// Set by SIGINT and SIGTERM, solves then return their best incumbent
+volatile int interrupted = 0;
+
+extern "C" void handleInterrupt(int signal)
+{
+	interrupted = 1;
+	// A second signal kills the process as usual
+	std::signal(signal, SIG_DFL);
+}
+
+void catchInterrupts()
+{
+	std::signal(SIGINT, handleInterrupt);
+	std::signal(SIGTERM, handleInterrupt);
+}
 
 TargetMappings readMappings(const std::string& path)
 {
 	TargetMappings mappings;
+	Stopwatch watch;
+
+	if(isBinaryMappings(path)) {
+		if(!filter.empty()) {
+			std::cerr << "Filters only apply to text mappings, '" << path
+			          << "' is binary.\n";
+			exit(-1);
+		}
+
+		try {
+			readBinaryMappings(path, mappings);
+		} catch(const std::runtime_error& e) {
+			std::cerr << e.what() << '\n';
+			exit(-1);
+		}
 
-	std::ifstream input(path);
+		statistics.addPhase(watch.phase("load"));
+		return mappings;
+	}
 
-	if(!input) {
-		std::cerr << "Could not open file '" << path << "' for reading.\n";
+	const std::size_t threads = std::thread::hardware_concurrency();
+	if(!parseMappings(path, mappings, threads, filter)) {
+		if(std::ifstream(path)) {
+			std::cerr << "Could not parse file '" << path << "'.\n";
+		} else {
+			std::cerr << "Could not open file '" << path
+			          << "' for reading.\n";
+		}
 		exit(-1);
 	}
 
-	std::string mirna;
-	std::string gene;
-	input >> mirna >> gene;
-	while(input) {
-		mappings.add(mirna, gene);
-		input >> mirna >> gene;
+	statistics.addPhase(watch.phase("parse"));
+
+	watch.reset();
+	const std::size_t duplicates = mappings.finalize(threads);
+	statistics.addPhase(watch.phase("finalize"));
+	if(duplicates > 0) {
+		std::cerr << "Removed " << duplicates << " duplicate mappings.\n";
 	}
 
 	return mappings;
@@ -60,27 +131,215 @@ void writeList(const std::string& path, const std::vector<std::string>& items)
 	}
 }
 
+const char* findOption(int argc, char* argv[], const char* name)
+{
+	for(int i = 3; i + 1 < argc; ++i) {
+		if(strcmp(argv[i], name) == 0) {
+			return argv[i + 1];
+		}
+	}
+
+	return nullptr;
+}
+
+bool hasFlag(int argc, char* argv[], const char* name)
+{
+	for(int i = 3; i < argc; ++i) {
+		if(strcmp(argv[i], name) == 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/// Number of roundings for --approx, zero if the problem is solved exactly.
+bool parseApprox(int argc, char* argv[], std::size_t& rounds)
+{
+	rounds = 0;
+	if(!hasFlag(argc, argv, "--approx")) {
+		return true;
+	}
+
+	rounds = 16;
+	if(const char* value = findOption(argc, argv, "--rounds")) {
+		try {
+			rounds = std::max<std::size_t>(1, std::stoul(value));
+		} catch(const std::exception& e) {
+			std::cerr << "Could not convert " << value << " to a number\n";
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool parseDouble(int argc, char* argv[], const char* name, double& value)
+{
+	if(const char* text = findOption(argc, argv, name)) {
+		try {
+			value = std::stod(text);
+		} catch(const std::exception& e) {
+			std::cerr << "Could not convert " << text << " to a number\n";
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool parseLimits(int argc, char* argv[], SolveLimits& limits)
+{
+	return parseDouble(argc, argv, "--time-limit", limits.time) &&
+	       parseDouble(argc, argv, "--gap", limits.gap);
+}
+
+bool parseJobs(int argc, char* argv[], std::size_t& jobs)
+{
+	if(const char* value = findOption(argc, argv, "--jobs")) {
+		try {
+			jobs = std::stoul(value);
+		} catch(const std::exception& e) {
+			std::cerr << "Could not convert " << value << " to a number\n";
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/// Reads the gene allow-list and score thresholds into the global filter.
+bool parseFilter(int argc, char* argv[])
+{
+	if(const char* path = findOption(argc, argv, "--genes")) {
+		std::ifstream input(path);
+		if(!input) {
+			std::cerr << "Could not open file '" << path << "' for reading.\n";
+			return false;
+		}
+
+		filter.restrict_genes = true;
+		std::string gene;
+		while(input >> gene) {
+			filter.genes.insert(gene);
+		}
+	}
+
+	// column:value pairs separated by commas
+	if(const char* value = findOption(argc, argv, "--min-score")) {
+		std::istringstream fields(value);
+		std::string field;
+		while(std::getline(fields, field, ',')) {
+			MappingsFilter::Threshold threshold{0, 0.0};
+			const std::size_t colon = field.find(':');
+			try {
+				threshold.column = std::stoul(field.substr(0, colon));
+				threshold.min_score = std::stod(field.substr(colon + 1));
+			} catch(const std::exception& e) {
+				threshold.column = 0;
+			}
+
+			if(colon == std::string::npos || threshold.column < 3) {
+				std::cerr << "Invalid score threshold '" << field
+				          << "', expected column:value with column >= 3.\n";
+				return false;
+			}
+
+			filter.thresholds.push_back(threshold);
+		}
+	}
+
+	return true;
+}
+
 const char* commandList()
 {
-	return "\tminmax\n\tmaxgene\n\tmaxgene-curve\n\tminmirna\n\tminmirna-curve";
+	return "\tminmax\n\tminmax-sweep\n\tmaxgene\n\tmaxgene-curve\n\tminmirna\n"
+	       "\tminmirna-curve\n\tmerge-curves\n\tbatch\n\tserve\n\tconvert";
 }
 
 void printILPStatistics(const ILPProblem& problem)
 {
+	const auto& instance = problem.reducedInstance();
+	std::cout << "Reduced instance to " << instance.numMirnas()
+	          << " miRNA classes and " << instance.numGenes()
+	          << " gene classes.\n";
+
 	std::cout << "Created ILP formulation with " << problem.numVariables()
 	          << " variables, " << problem.numConstraints()
 	          << " constraints, and " << problem.numNonZero()
 	          << " non-zero entries.\n";
 }
 
+void printIncumbent(double objective, double bound, double seconds)
+{
+	std::cout << "Incumbent " << objective << " (bound " << bound
+	          << ") after " << seconds << "s.\n";
+}
+
 void solveProblem(ILPProblem& problem, const std::string& mpath,
-                  const std::string& gpath)
+                  const std::string& gpath, const SolveLimits& limits,
+                  std::size_t approx_rounds = 0)
 {
 	printILPStatistics(problem);
+	statistics.addPhases(problem.buildTimes());
+
+	std::vector<std::string> mirnas;
+	std::vector<std::string> genes;
+	if(approx_rounds > 0) {
+		std::tie(mirnas, genes) = problem.solveApproximately(approx_rounds);
+		std::cout << "Rounded the LP relaxation to objective "
+		          << problem.objectiveValue() << ", LP bound "
+		          << problem.lpBound() << " (gap "
+		          << 100.0 * problem.solveStats().gap << "%).\n";
+	} else {
+		catchInterrupts();
+		problem.setLimits(limits);
+		problem.setTerminationFlag(&interrupted);
+		problem.setIncumbentCallback(printIncumbent);
+		std::tie(mirnas, genes) = problem.solve();
+
+		const SolveStats& stats = problem.solveStats();
+		if(!stats.optimal) {
+			std::cout << "Stopped with status '" << stats.status
+			          << "': objective " << stats.objective << ", bound "
+			          << stats.bound << " (gap " << 100.0 * stats.gap
+			          << "%).\n";
+		}
+	}
+	statistics.addSolve(problem.solveStats());
+
+	std::cout << "Solution contains " << mirnas.size() << " miRNAs and "
+	          << genes.size() << " genes.\n";
+
+	writeList(mpath, mirnas);
+	writeList(gpath, genes);
+}
 
+void writeSelection(const TargetMappings& mappings,
+                    const std::vector<std::size_t>& selection,
+                    const std::string& mpath, const std::string& gpath)
+{
+	std::vector<bool> selected(mappings.numMirnas(), false);
 	std::vector<std::string> mirnas;
+	for(std::size_t m : selection) {
+		selected[m] = true;
+		mirnas.emplace_back(mappings.mirna(m));
+	}
+
+	std::vector<bool> covered(mappings.numGenes(), false);
+	for(const auto& mapping : mappings) {
+		if(selected[mapping.mirna()]) {
+			covered[mapping.gene()] = true;
+		}
+	}
+
 	std::vector<std::string> genes;
-	std::tie(mirnas, genes) = problem.solve();
+	for(size_t i = 0; i < mappings.numGenes(); ++i) {
+		if(covered[i]) {
+			genes.emplace_back(mappings.gene(i));
+		}
+	}
 
 	std::cout << "Solution contains " << mirnas.size() << " miRNAs and "
 	          << genes.size() << " genes.\n";
@@ -89,15 +348,60 @@ void solveProblem(ILPProblem& problem, const std::string& mpath,
 	writeList(gpath, genes);
 }
 
+/// Writes the cached solution of the problem, if there is one.
+bool loadCached(const TargetMappings& mappings, const std::string& problem,
+                const std::string& mpath, const std::string& gpath)
+{
+	ResultCache::Entry entry;
+	if(!cache || !cache->load(mappings.contentHash(), problem, entry)) {
+		return false;
+	}
+
+	std::cout << "Loaded cached solution with objective " << entry.objective
+	          << ".\n";
+	writeSelection(mappings, entry.mirnas, mpath, gpath);
+
+	return true;
+}
+
+void storeCached(const TargetMappings& mappings, const std::string& problem,
+                 double objective, const std::vector<std::size_t>& mirnas)
+{
+	if(!cache) {
+		return;
+	}
+
+	ResultCache::Entry entry;
+	entry.objective = objective;
+	entry.mirnas = mirnas;
+	cache->store(mappings.contentHash(), problem, entry);
+}
+
+void storeCached(const TargetMappings& mappings, const std::string& problem,
+                 const ILPProblem& solved)
+{
+	if(ResultCache::cacheable(solved.solveStats())) {
+		storeCached(mappings, problem, solved.objectiveValue(),
+		            solved.selectedMirnas());
+	}
+}
+
 int minMax(int argc, char* argv[], TargetMappings& mappings)
 {
 	if(argc <= 6) {
 		std::cerr << "Not enough arguments supplied. Usage:\n\t" << argv[0]
 		          << " minmax mappings.txt mirna_weight gene_weight mirnas.out "
-		             "genes.out\n";
+		             "genes.out [--time-limit s] [--gap g] "
+		             "[--approx [--rounds N]]\n";
 		return -3;
 	}
 
+	std::size_t rounds = 0;
+	SolveLimits limits;
+	if(!parseApprox(argc, argv, rounds) || !parseLimits(argc, argv, limits)) {
+		return -4;
+	}
+
 	double mirnaWeight = 0.0;
 	double geneWeight = 0.0;
 
@@ -109,8 +413,186 @@ int minMax(int argc, char* argv[], TargetMappings& mappings)
 		return -4;
 	}
 
+	const auto key =
+	    ResultCache::problemKey("minmax", {mirnaWeight, geneWeight});
+	if(loadCached(mappings, key, argv[5], argv[6])) {
+		return 0;
+	}
+
 	MinMaxProblem problem(mappings, mirnaWeight, geneWeight);
-	solveProblem(problem, argv[5], argv[6]);
+	solveProblem(problem, argv[5], argv[6], limits, rounds);
+	storeCached(mappings, key, problem);
+
+	return 0;
+}
+
+/// Bounds maxgene by Lagrangian relaxation alone and writes the best
+/// solution found on the way.
+int boundMaxGene(char* argv[], TargetMappings& mappings, std::size_t k)
+{
+	Stopwatch watch;
+	InstanceReduction instance(mappings);
+	GreedyCover greedy(instance);
+	LagrangianBound lagrangian(instance);
+
+	auto selection = greedy.maxCoverage(k);
+	const double greedy_objective = greedy.coveredWeight(selection);
+	const double bound = lagrangian.maxCoverage(k, greedy_objective);
+	if(lagrangian.lowerBound() > greedy_objective) {
+		selection = lagrangian.selection();
+	}
+	statistics.addPhase(watch.phase("lagrangian"));
+
+	const double objective = lagrangian.lowerBound();
+	std::cout << "Lagrangian bound " << bound << " after "
+	          << lagrangian.iterations() << " iterations, best solution "
+	          << objective << " (gap "
+	          << 100.0 * (bound - objective) / std::max(objective, 1.0)
+	          << "%).\n";
+
+	writeSelection(mappings, instance.expandMirnas(selection), argv[4],
+	               argv[5]);
+
+	return 0;
+}
+
+/**
+ * Solves maxgene over several connected components. Only the small
+ * components get a full coverage curve, the largest one is solved directly
+ * for every split of the budget that can still beat the best combination.
+ */
+int maxGeneComponents(char* argv[], const TargetMappings& mappings,
+                      const ConnectedComponents& components, std::size_t k,
+                      std::size_t jobs, const SolveLimits& limits,
+                      bool lagrangian, const std::string& key)
+{
+	std::size_t giant = 0;
+	for(std::size_t c = 1; c < components.size(); ++c) {
+		if(components.mappings(c).numMappings() >
+		   components.mappings(giant).numMappings()) {
+			giant = c;
+		}
+	}
+
+	TargetMappings small;
+	for(std::size_t c = 0; c < components.size(); ++c) {
+		if(c == giant) {
+			continue;
+		}
+		const TargetMappings& part = components.mappings(c);
+		for(const auto& mapping : part) {
+			small.add(part.mirna(mapping.mirna()), part.gene(mapping.gene()));
+		}
+	}
+	small.finalize();
+
+	catchInterrupts();
+	Stopwatch watch;
+	MaxGeneCurve curve(small);
+	curve.setVerbose(false);
+	curve.setNumJobs(jobs);
+	curve.setMaxMirnas(std::min(k, small.numMirnas()));
+	curve.setSolveLimits({0.0, limits.gap});
+	curve.setTimeLimit(limits.time);
+	curve.setTerminationFlag(&interrupted);
+	curve.setLagrangianBound(lagrangian);
+	curve.setCache(cache.get());
+	const auto small_curve = curve.compute();
+	statistics.addSolves(curve.solveStats());
+	bool optimal = curve.complete();
+	// Solves stopped at a relaxed gap may miss the optimum, their results
+	// must not be stored under the exact key
+	bool cacheable = optimal;
+	for(const auto& stats : curve.solveStats()) {
+		cacheable = cacheable && ResultCache::cacheable(stats);
+	}
+
+	const TargetMappings& giant_mappings = components.mappings(giant);
+	const std::size_t small_k = small_curve.size() - 1;
+	const std::size_t giant_k = std::min(k, giant_mappings.numMirnas());
+	const std::size_t lowest_k =
+	    std::min(giant_k, k > small_k ? k - small_k : std::size_t(0));
+
+	MaxGeneProblem problem(giant_mappings, giant_k);
+	problem.setTerminationFlag(&interrupted);
+	if(lagrangian) {
+		problem.setLagrangianBound(true);
+	}
+
+	// Coverage is monotone in the budget, so a bound for j miRNAs also
+	// bounds every smaller j.
+	double upper = giant_mappings.numGenes();
+	double best = -1.0;
+	std::size_t best_j = giant_k;
+	std::vector<std::size_t> best_giant;
+	for(std::size_t j = giant_k + 1; j-- > lowest_k;) {
+		const std::size_t rest = small_curve[std::min(k - j, small_k)];
+		if(upper + rest <= best) {
+			continue;
+		}
+
+		SolveLimits budget{0.0, limits.gap};
+		if(limits.time > 0.0) {
+			budget.time = limits.time - watch.wall();
+			if(budget.time <= 0.0) {
+				optimal = false;
+				break;
+			}
+		}
+		if(interrupted) {
+			optimal = false;
+			break;
+		}
+
+		problem.setNumMirna(j);
+		problem.setLimits(budget);
+		problem.solve();
+
+		SolveStats stats = problem.solveStats();
+		stats.k = j;
+		statistics.addSolve(stats);
+		optimal = optimal && stats.optimal;
+		cacheable = cacheable && ResultCache::cacheable(stats);
+		// Within the gap limit the incumbent may still be below the optimum
+		upper = std::floor(stats.bound + 1e-6);
+
+		if(problem.objectiveValue() + rest > best) {
+			best = problem.objectiveValue() + rest;
+			best_j = j;
+			best_giant = problem.selectedMirnas();
+		}
+	}
+
+	std::vector<std::size_t> selection;
+	for(std::size_t m : best_giant) {
+		selection.push_back(components.mirnas(giant)[m]);
+	}
+	for(std::size_t m : curve.selection(std::min(k - best_j, small_k))) {
+		selection.push_back(mappings.mirnaNames().find(small.mirna(m)));
+	}
+
+	if(!optimal) {
+		std::cout << "Stopped before all components were solved, the "
+		             "solution is the best combination found so far.\n";
+	}
+
+	// The components hold fewer than k miRNAs or the small curve stopped
+	// early, the remaining budget is filled in id order
+	std::vector<bool> selected(mappings.numMirnas(), false);
+	for(std::size_t m : selection) {
+		selected[m] = true;
+	}
+	for(std::size_t m = 0; m < mappings.numMirnas() && selection.size() < k;
+	    ++m) {
+		if(!selected[m]) {
+			selection.push_back(m);
+		}
+	}
+
+	writeSelection(mappings, selection, argv[4], argv[5]);
+	if(cacheable) {
+		storeCached(mappings, key, std::max(best, 0.0), selection);
+	}
 
 	return 0;
 }
@@ -119,7 +601,9 @@ int maxGene(int argc, char* argv[], TargetMappings& mappings)
 {
 	if(argc <= 5) {
 		std::cerr << "Not enough arguments supplied. Usage:\n\t" << argv[0]
-		          << " minmax mappings.txt num_mirna mirnas.out genes.out\n";
+		          << " maxgene mappings.txt num_mirna mirnas.out genes.out "
+		             "[--jobs N] [--time-limit s] [--gap g] "
+		             "[--approx [--rounds N]] [--lagrangian | --bound-only]\n";
 		return -3;
 	}
 
@@ -131,14 +615,87 @@ int maxGene(int argc, char* argv[], TargetMappings& mappings)
 		return -6;
 	}
 
+	std::size_t jobs = 1;
+	std::size_t rounds = 0;
+	SolveLimits limits;
+	if(!parseJobs(argc, argv, jobs) || !parseApprox(argc, argv, rounds) ||
+	   !parseLimits(argc, argv, limits)) {
+		return -6;
+	}
+
+	if(hasFlag(argc, argv, "--bound-only")) {
+		return boundMaxGene(argv, mappings, num_mirnas);
+	}
+
+	const auto key = ResultCache::problemKey("maxgene", {double(num_mirnas)});
+	if(loadCached(mappings, key, argv[4], argv[5])) {
+		return 0;
+	}
+
+	const bool lagrangian = hasFlag(argc, argv, "--lagrangian");
+
+	// Independent components are solved separately and combined exactly
+	if(rounds == 0) {
+		ConnectedComponents components(mappings);
+		if(components.size() > 1) {
+			return maxGeneComponents(argv, mappings, components, num_mirnas,
+			                         jobs, limits, lagrangian, key);
+		}
+	}
+
 	MaxGeneProblem problem(mappings, num_mirnas);
-	solveProblem(problem, argv[4], argv[5]);
+	if(lagrangian) {
+		Stopwatch watch;
+		problem.setLagrangianBound(true);
+		statistics.addPhase(watch.phase("lagrangian"));
+		std::cout << "Lagrangian bound " << problem.lagrangianBound()
+		          << ", best heuristic solution "
+		          << problem.heuristicObjective() << ".\n";
+	}
+
+	solveProblem(problem, argv[4], argv[5], limits, rounds);
+	storeCached(mappings, key, problem);
 
 	return 0;
 }
 
 int maxGeneCurve(int argc, char* argv[], TargetMappings& mappings)
 {
+	if(argc <= 3) {
+		std::cerr << "Not enough arguments supplied. Usage:\n\t" << argv[0]
+		          << " maxgene-curve mappings.txt curve.out [--jobs N] "
+		             "[--time-limit s] [--gap g] [--curve-time-limit s] "
+		             "[--lagrangian] [--adaptive [--bisect]] [--shard i/N]\n";
+		return -3;
+	}
+
+	// Shard i of N solves every k with k % N == i
+	std::size_t shard = 0;
+	std::size_t num_shards = 0;
+	if(const char* value = findOption(argc, argv, "--shard")) {
+		char slash = 0;
+		std::istringstream fields(value);
+		if(!(fields >> shard >> slash >> num_shards) || slash != '/' ||
+		   shard >= num_shards) {
+			std::cerr << "Invalid shard '" << value
+			          << "', expected i/N with 0 <= i < N.\n";
+			return -6;
+		}
+
+		if(hasFlag(argc, argv, "--adaptive")) {
+			std::cerr << "Shards cannot be computed adaptively.\n";
+			return -6;
+		}
+	}
+
+	std::size_t jobs = 1;
+	SolveLimits limits;
+	double curve_limit = 0.0;
+	if(!parseJobs(argc, argv, jobs) || !parseLimits(argc, argv, limits) ||
+	   !parseDouble(argc, argv, "--curve-time-limit", curve_limit)) {
+		return -6;
+	}
+
 	std::ofstream curve(argv[3]);
 
 	if(!curve) {
@@ -146,45 +703,483 @@ int maxGeneCurve(int argc, char* argv[], TargetMappings& mappings)
 		return -9;
 	}
 
-	MaxGeneProblem problem(mappings, 0);
+	catchInterrupts();
+	MaxGeneCurve solver(mappings);
+	solver.setNumJobs(jobs);
+	solver.setSolveLimits(limits);
+	solver.setTimeLimit(curve_limit);
+	solver.setTerminationFlag(&interrupted);
+	solver.setLagrangianBound(hasFlag(argc, argv, "--lagrangian"));
+	const bool adaptive = hasFlag(argc, argv, "--adaptive");
+	solver.setAdaptive(adaptive, hasFlag(argc, argv, "--bisect"));
+	solver.setCache(cache.get());
+
+	if(num_shards > 0) {
+		curve.close();
+		const auto partial = solver.computeShard(shard, num_shards);
+		statistics.addSolves(solver.solveStats());
+		try {
+			writePartialCurve(argv[3], partial);
+		} catch(const std::runtime_error& e) {
+			std::cerr << e.what() << '\n';
+			return -8;
+		}
+
+		if(!solver.complete()) {
+			std::cout << "Stopped early or hit a limit, some points of the "
+			             "shard are only bounded.\n";
+		}
+
+		return 0;
+	}
+
+	const auto genes = solver.compute();
+	statistics.addSolves(solver.solveStats());
+	for(std::size_t i = 0; i < genes.size(); ++i) {
+		curve << i << '\t' << genes[i] << '\n';
+	}
+
+	if(!solver.complete() && adaptive) {
+		std::cout << "Stopped early, unresolved points are lower bounds.\n";
+	} else if(!solver.complete()) {
+		std::cout << "Stopped early, the curve ends at " << genes.size() - 1
+		          << " miRNAs.\n";
+	}
+
+	return 0;
+}
+
+int minMirna(int argc, char* argv[], TargetMappings& mappings)
+{
+	if(argc <= 4) {
+		std::cerr << "Not enough arguments supplied. Usage:\n\t" << argv[0]
+		          << " minmirna mappings.txt mirnas.out genes.out "
+		             "[--coverage fraction] [--time-limit s] [--gap g]\n";
+		return -3;
+	}
+
+	SolveLimits limits;
+	if(!parseLimits(argc, argv, limits)) {
+		return -6;
+	}
+
+	double coverage = 1.0;
+	if(const char* value = findOption(argc, argv, "--coverage")) {
+		try {
+			coverage = std::stod(value);
+		} catch(const std::exception& e) {
+			std::cerr << "Could not convert " << value << " to a number\n";
+			return -6;
+		}
+	}
+
+	if(coverage <= 0.0 || coverage > 1.0) {
+		std::cerr << "The coverage needs to be in (0, 1].\n";
+		return -4;
+	}
+
+	const auto num_genes = static_cast<std::size_t>(
+	    std::ceil(coverage * mappings.numGenes() - 1e-9));
+
+	const auto key = ResultCache::problemKey("minmirna", {double(num_genes)});
+	if(loadCached(mappings, key, argv[3], argv[4])) {
+		return 0;
+	}
+
+	MinMirnaProblem problem(mappings, num_genes);
+	solveProblem(problem, argv[3], argv[4], limits);
+	storeCached(mappings, key, problem);
+
+	return 0;
+}
+
+int minMirnaCurve(int argc, char* argv[], TargetMappings& mappings)
+{
+	if(argc <= 3) {
+		std::cerr << "Not enough arguments supplied. Usage:\n\t" << argv[0]
+		          << " minmirna-curve mappings.txt curve.out [--time-limit s] "
+		             "[--gap g] [--curve-time-limit s]\n";
+		return -3;
+	}
+
+	SolveLimits limits;
+	double curve_limit = 0.0;
+	if(!parseLimits(argc, argv, limits) ||
+	   !parseDouble(argc, argv, "--curve-time-limit", curve_limit)) {
+		return -6;
+	}
+
+	std::ofstream curve(argv[3]);
+
+	if(!curve) {
+		std::cerr << "Could not open file '" << argv[3] << "' for writing!\n";
+		return -9;
+	}
+
+	MinMirnaProblem problem(mappings, 0);
 	printILPStatistics(problem);
+	statistics.addPhases(problem.buildTimes());
 
-	curve << "0\t0\n";
+	const std::size_t num_genes = mappings.numGenes();
+	std::vector<std::size_t> mirnas(num_genes + 1, 0);
+	// Lower bounds of the levels whose solve was stopped by a limit
+	std::vector<std::size_t> bounds(num_genes + 1, 0);
+	std::vector<bool> exact(num_genes + 1, true);
+	std::size_t num_bounded = 0;
 
-	std::size_t i = 1;
-	for(; i <= mappings.numMirnas(); ++i) {
-		std::cout << "\rProcessing " << i << "/" << mappings.numMirnas();
-		std::cout.flush();
-		problem.setNumMirna(i);
-		auto result = problem.solve();
+	// An optimal solution for g genes with k miRNAs covering c >= g genes
+	// is optimal for all targets up to c, as the curve is monotone.
+	std::vector<std::size_t> previous;
+	std::size_t num_solves = 0;
 
-		curve << i << '\t' << result.second.size() << '\n';
+	catchInterrupts();
+	problem.setTerminationFlag(&interrupted);
+	Stopwatch watch;
 
-		if(result.second.size() == mappings.numGenes() &&
-		   i != mappings.numMirnas()) {
-			std::cout << "\nCovered all available target genes. Exiting early.";
+	std::size_t g = 1;
+	while(g <= num_genes) {
+		const double remaining = curve_limit - watch.wall();
+		if(interrupted || (curve_limit > 0.0 && remaining <= 0.0)) {
 			break;
 		}
+
+		// The last solve gets at most the remaining curve budget
+		SolveLimits budget = limits;
+		if(curve_limit > 0.0 &&
+		   (budget.time <= 0.0 || remaining < budget.time)) {
+			budget.time = remaining;
+		}
+
+		std::cout << "\rProcessing " << g << "/" << num_genes;
+		std::cout.flush();
+		problem.setLimits(budget);
+		problem.setNumGenes(g);
+		problem.warmStart(previous);
+
+		ILPProblem::Result result;
+		try {
+			result = problem.solve();
+		} catch(const CPLEXException&) {
+			// Solves cut short may not have a solution
+			const bool expired =
+			    curve_limit > 0.0 && watch.wall() >= curve_limit;
+			if(!interrupted && !expired) {
+				throw;
+			}
+			break;
+		}
+		++num_solves;
+
+		SolveStats stats = problem.solveStats();
+		stats.k = g;
+		statistics.addSolve(stats);
+
+		previous = problem.selectedMirnas();
+
+		if(!stats.optimal) {
+			mirnas[g] = result.first.size();
+			bounds[g] = std::ceil(stats.bound - 1e-6);
+			exact[g] = false;
+			++num_bounded;
+			++g;
+			continue;
+		}
+
+		const std::size_t covered = std::max(g, result.second.size());
+		for(; g <= covered; ++g) {
+			mirnas[g] = result.first.size();
+		}
 	}
 
-	std::cout << '\n';
+	std::cout << "\nSolved " << num_solves << " ILPs for " << g - 1 << "/"
+	          << num_genes << " coverage levels.\n";
+	if(num_bounded > 0) {
+		std::cout << num_bounded << " levels were stopped by a limit, their "
+		             "lines carry the lower bound as a third column.\n";
+	}
 
-	for(++i; i <= mappings.numMirnas(); ++i) {
-		curve << i << '\t' << mappings.numGenes() << '\n';
+	for(std::size_t i = 0; i < g; ++i) {
+		curve << i << '\t' << mirnas[i];
+		if(!exact[i]) {
+			curve << '\t' << bounds[i];
+		}
+		curve << '\n';
 	}
 
 	return 0;
 }
 
-int minMirna(int argc, char* argv[], TargetMappings& mappings)
+void writeJoined(std::ostream& output, const TargetMappings& mappings,
+                 const std::vector<std::size_t>& ids, bool mirnas)
+{
+	for(size_t i = 0; i < ids.size(); ++i) {
+		output << (i > 0 ? "," : "")
+		       << (mirnas ? mappings.mirna(ids[i]) : mappings.gene(ids[i]));
+	}
+}
+
+int minMaxSweep(int argc, char* argv[], TargetMappings& mappings)
 {
-	std::cerr << "Not yet implemented!\n";
+	if(argc <= 3) {
+		std::cerr << "Not enough arguments supplied. Usage:\n\t" << argv[0]
+		          << " minmax-sweep mappings.txt front.out [--time-limit s] "
+		             "[--gap g]\n";
+		return -3;
+	}
+
+	SolveLimits limits;
+	if(!parseLimits(argc, argv, limits)) {
+		return -6;
+	}
+
+	std::ofstream front(argv[3]);
+	if(!front) {
+		std::cerr << "Could not open file '" << argv[3] << "' for writing!\n";
+		return -9;
+	}
+
+	catchInterrupts();
+	MinMaxSweep sweep(mappings);
+	sweep.setSolveLimits(limits);
+	sweep.setTerminationFlag(&interrupted);
+
+	const auto& points = sweep.compute();
+	statistics.addSolves(sweep.solveStats());
+
+	// Point i is optimal for mirna_weight / gene_weight between the slopes
+	// of the hull to its right and to its left.
+	auto slope = [&points](std::size_t i) {
+		return (double(points[i + 1].genes) - points[i].genes) /
+		       (double(points[i + 1].mirnas) - points[i].mirnas);
+	};
+
+	// miRNAs, genes, range of the weight ratio, selected miRNAs
+	for(size_t i = 0; i < points.size(); ++i) {
+		front << points[i].mirnas << '\t' << points[i].genes << '\t'
+		      << (i + 1 < points.size() ? slope(i) : 0.0) << '\t';
+		if(i > 0) {
+			front << slope(i - 1);
+		} else {
+			front << "inf";
+		}
+		front << '\t';
+		writeJoined(front, mappings, points[i].selection, true);
+		front << '\n';
+	}
+
+	std::cout << "Found " << points.size() << " Pareto-optimal points with "
+	          << sweep.solveStats().size() << " solves.\n";
+	if(!sweep.complete()) {
+		std::cout << "Stopped early, the front may lack points.\n";
+	}
+
 	return 0;
 }
 
-int minMirnaCurve(int argc, char* argv[], TargetMappings& mappings)
+/// Does not read any mappings, the shards carry their content hash.
+int mergeCurves(int argc, char* argv[])
+{
+	if(argc <= 3) {
+		std::cerr << "Not enough arguments supplied. Usage:\n\t" << argv[0]
+		          << " merge-curves curve.out shard.out [shard.out ...]\n";
+		return -3;
+	}
+
+	std::vector<std::size_t> lower;
+	std::vector<std::size_t> upper;
+	try {
+		std::vector<PartialCurve> shards;
+		for(int i = 3; i < argc && strncmp(argv[i], "--", 2) != 0; ++i) {
+			shards.push_back(readPartialCurve(argv[i]));
+		}
+
+		mergePartialCurves(shards, lower, upper);
+	} catch(const std::runtime_error& e) {
+		std::cerr << e.what() << '\n';
+		return -4;
+	}
+
+	std::ofstream curve(argv[2]);
+	if(!curve) {
+		std::cerr << "Could not open file '" << argv[2] << "' for writing!\n";
+		return -9;
+	}
+
+	std::size_t num_unresolved = 0;
+	for(std::size_t k = 0; k < lower.size(); ++k) {
+		curve << k << '\t' << lower[k] << '\n';
+		num_unresolved += lower[k] < upper[k] ? 1 : 0;
+	}
+
+	if(num_unresolved > 0) {
+		std::cout << num_unresolved << " points are unresolved, the curve "
+		          << "holds lower bounds for them.\n";
+	}
+
+	return 0;
+}
+
+int batch(int argc, char* argv[], TargetMappings& mappings)
 {
-	std::cerr << "Not yet implemented!\n";
+	if(argc <= 6 || (strcmp(argv[5], "minmax") == 0 && argc <= 7)) {
+		std::cerr << "Not enough arguments supplied. Usage:\n\t" << argv[0]
+		          << " batch mappings.txt genesets.txt results.out "
+		             "maxgene num_mirna [--jobs N]\n\t"
+		          << argv[0] << " batch mappings.txt genesets.txt "
+		                        "results.out minmax mirna_weight gene_weight "
+		                        "[--jobs N]\n"
+		          << "Every gene set may be limited with [--time-limit s] "
+		             "[--gap g].\n";
+		return -3;
+	}
+
+	SolveLimits limits;
+	if(!parseLimits(argc, argv, limits)) {
+		return -6;
+	}
+
+	BatchSolver::ProblemFactory factory;
+	std::string key;
+	try {
+		if(strcmp(argv[5], "maxgene") == 0) {
+			const std::size_t k = std::stoul(argv[6]);
+			key = ResultCache::problemKey("maxgene", {double(k)});
+			factory = [k](TargetMappings&& m) {
+				return std::unique_ptr<ILPProblem>(
+				    new MaxGeneProblem(std::move(m), k));
+			};
+		} else if(strcmp(argv[5], "minmax") == 0) {
+			const double mirna_weight = std::stod(argv[6]);
+			const double gene_weight = std::stod(argv[7]);
+			key = ResultCache::problemKey("minmax",
+			                              {mirna_weight, gene_weight});
+			factory = [mirna_weight, gene_weight](TargetMappings&& m) {
+				return std::unique_ptr<ILPProblem>(
+				    new MinMaxProblem(std::move(m), mirna_weight, gene_weight));
+			};
+		} else {
+			std::cerr << "Unknown batch problem '" << argv[5]
+			          << "', expected maxgene or minmax.\n";
+			return -2;
+		}
+	} catch(const std::exception& e) {
+		std::cerr << "Error converting argument to a number\n";
+		return -4;
+	}
+
+	std::size_t jobs = 1;
+	if(!parseJobs(argc, argv, jobs)) {
+		return -6;
+	}
+
+	std::vector<GeneSet> sets;
+	std::size_t num_unknown = 0;
+	if(!readGeneSets(argv[3], mappings, sets, num_unknown)) {
+		std::cerr << "Could not open file '" << argv[3] << "' for reading.\n";
+		return -1;
+	}
+
+	std::cout << "Read " << sets.size() << " gene sets, skipped "
+	          << num_unknown << " genes without mappings.\n";
+
+	std::ofstream output(argv[4]);
+	if(!output) {
+		std::cerr << "Could not open file '" << argv[4] << "' for writing.\n";
+		return -8;
+	}
+
+	// Interrupted solves return their incumbent, such that the results of
+	// the remaining gene sets are written quickly.
+	catchInterrupts();
+	auto limited = [factory, limits](TargetMappings&& m) {
+		std::unique_ptr<ILPProblem> problem = factory(std::move(m));
+		problem->setLimits(limits);
+		problem->setTerminationFlag(&interrupted);
+		return problem;
+	};
+
+	BatchSolver solver(mappings, limited);
+	solver.setNumJobs(jobs);
+	solver.setCache(cache.get(), key);
+	const auto results = solver.solve(sets);
+	for(const auto& result : results) {
+		statistics.addSolve(result.stats);
+	}
+
+	// name, genes in the set, covered genes, objective, miRNAs, covered genes
+	for(size_t i = 0; i < sets.size(); ++i) {
+		output << sets[i].name << '\t' << sets[i].genes.size() << '\t'
+		       << results[i].genes.size() << '\t' << results[i].objective
+		       << '\t';
+		writeJoined(output, mappings, results[i].mirnas, true);
+		output << '\t';
+		writeJoined(output, mappings, results[i].genes, false);
+		output << '\n';
+	}
+
+	return 0;
+}
+
+int serve(int argc, char* argv[], TargetMappings& mappings)
+{
+	std::size_t jobs = 1;
+	SolveLimits limits;
+	if(!parseJobs(argc, argv, jobs) || !parseLimits(argc, argv, limits)) {
+		return -6;
+	}
+
+	QueryServer server;
+	server.setNumJobs(jobs);
+	server.setLimits(limits);
+	server.setCache(cache.get());
+	server.addMappings(argv[2], mappings);
+
+	// Further tables precede the options
+	std::vector<TargetMappings> tables;
+	int i = 3;
+	for(; i < argc && strncmp(argv[i], "--", 2) != 0; ++i) {
+	}
+
+	tables.reserve(i - 3);
+	for(int j = 3; j < i; ++j) {
+		tables.push_back(readMappings(argv[j]));
+		server.addMappings(argv[j], tables.back());
+		std::cerr << "Loaded '" << argv[j] << "'.\n";
+	}
+
+	if(const char* path = findOption(argc, argv, "--socket")) {
+		try {
+			std::cerr << "Listening on '" << path << "'.\n";
+			server.serveSocket(path);
+		} catch(const std::runtime_error& e) {
+			std::cerr << e.what() << '\n';
+			return -8;
+		}
+	}
+
+	server.serveStream(STDIN_FILENO, STDOUT_FILENO);
+
+	return 0;
+}
+
+int convert(int argc, char* argv[], TargetMappings& mappings)
+{
+	if(argc <= 3) {
+		std::cerr << "Not enough arguments supplied. Usage:\n\t" << argv[0]
+		          << " convert mappings.txt mappings.bin\n";
+		return -3;
+	}
+
+	try {
+		writeBinaryMappings(argv[3], mappings);
+	} catch(const std::runtime_error& e) {
+		std::cerr << e.what() << '\n';
+		return -8;
+	}
+
+	std::cout << "Wrote " << mappings.numMappings()
+	          << " unique mappings to '" << argv[3] << "'.\n";
+
 	return 0;
 }
 
@@ -192,6 +1187,8 @@ int dispatchCLIArguments(int argc, char* argv[], TargetMappings& mappings)
 {
 	if(strcmp(argv[1], "minmax") == 0) {
 		return minMax(argc, argv, mappings);
+	} else if(strcmp(argv[1], "minmax-sweep") == 0) {
+		return minMaxSweep(argc, argv, mappings);
 	} else if(strcmp(argv[1], "maxgene") == 0) {
 		return maxGene(argc, argv, mappings);
 	} else if(strcmp(argv[1], "maxgene-curve") == 0) {
@@ -200,6 +1197,12 @@ int dispatchCLIArguments(int argc, char* argv[], TargetMappings& mappings)
 		return minMirna(argc, argv, mappings);
 	} else if(strcmp(argv[1], "minmirna-curve") == 0) {
 		return minMirnaCurve(argc, argv, mappings);
+	} else if(strcmp(argv[1], "batch") == 0) {
+		return batch(argc, argv, mappings);
+	} else if(strcmp(argv[1], "serve") == 0) {
+		return serve(argc, argv, mappings);
+	} else if(strcmp(argv[1], "convert") == 0) {
+		return convert(argc, argv, mappings);
 	} else {
 		std::cerr << "Unknown command '" << argv[1]
 		          << "'.\n\nAvailable commands:\n" << commandList() << '\n';
@@ -207,11 +1210,27 @@ int dispatchCLIArguments(int argc, char* argv[], TargetMappings& mappings)
 	}
 }
 
-void printMappingStatistics(const TargetMappings& mappings)
+void writeStatistics(const char* path)
 {
-	std::cout << "Read " << mappings.numMappings() << " mappings between "
-	          << mappings.numMirnas() << " miRNAs and " << mappings.numGenes()
-	          << " genes.\n";
+	if(!path) {
+		statistics.writeJson(std::cerr);
+		return;
+	}
+
+	std::ofstream output(path);
+	if(!output) {
+		std::cerr << "Could not open file '" << path << "' for writing.\n";
+		return;
+	}
+
+	statistics.writeJson(output);
+}
+
+void printMappingStatistics(std::ostream& out, const TargetMappings& mappings)
+{
+	out << "Read " << mappings.numMappings() << " mappings between "
+	    << mappings.numMirnas() << " miRNAs and " << mappings.numGenes()
+	    << " genes.\n";
 }
 
 int main(int argc, char* argv[])
@@ -219,19 +1238,57 @@ int main(int argc, char* argv[])
 	if(argc <= 2) {
 		std::cerr << "Not enough arguments supplied. Usage:\n\n\t" << argv[0]
 		          << " [command] mappings.txt [...]\n\nAvailable commands:\n"
-		          << commandList() << '\n';
+		          << commandList()
+		          << "\n\nAll commands accept --stats json [--stats-file path] "
+		             "to report timings\nand solver statistics, and --cache "
+		             "dir to reuse optimal results of\nearlier runs. Text "
+		             "mappings, also gzip compressed, are filtered while\n"
+		             "parsing with --genes allowed_genes.txt and --min-score "
+		             "column:value[,...].\n";
 		return -1;
 	}
 
+	const char* stats_format = findOption(argc, argv, "--stats");
+	if(stats_format && strcmp(stats_format, "json") != 0) {
+		std::cerr << "Unsupported statistics format '" << stats_format
+		          << "', only json is available.\n";
+		return -4;
+	}
+
+	if(!parseFilter(argc, argv)) {
+		return -4;
+	}
+
+	// Merging shards needs no mappings
+	if(strcmp(argv[1], "merge-curves") == 0) {
+		return mergeCurves(argc, argv);
+	}
+
+	if(const char* directory = findOption(argc, argv, "--cache")) {
+		try {
+			cache.reset(new ResultCache(directory));
+		} catch(const std::runtime_error& e) {
+			std::cerr << e.what() << '\n';
+			return -8;
+		}
+	}
+
 	auto mappings = readMappings(argv[2]);
-	printMappingStatistics(mappings);
+	// In serve mode, stdout is reserved for the responses
+	const bool serving = strcmp(argv[1], "serve") == 0;
+	printMappingStatistics(serving ? std::cerr : std::cout, mappings);
 
+	int result = 0;
 	try {
-		return dispatchCLIArguments(argc, argv, mappings);
+		result = dispatchCLIArguments(argc, argv, mappings);
 	} catch(const CPLEXException& e) {
 		std::cerr << "Error during ILP computation: " << e.what() << std::endl;
-		return -7;
+		result = -7;
 	}
 
-	return 0;
+	if(stats_format) {
+		writeStatistics(findOption(argc, argv, "--stats-file"));
+	}
+
+	return result;
 }